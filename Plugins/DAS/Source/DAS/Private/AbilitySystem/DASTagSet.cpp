@@ -0,0 +1,138 @@
+﻿
+#include "AbilitySystem/DASTagSet.h"
+#include "GameplayTagsManager.h"
+
+namespace DASTagRegistry
+{
+	bool bInitialized = false;
+	TArray<FGameplayTag> Tags;
+	TMap<FGameplayTag, int32> TagIndexes;
+
+	/** Номера тега и его родителей по номеру тега */
+	TArray<TArray<int32, TInlineAllocator<4>>> Lineages;
+
+	int32 RegisterTag(const FGameplayTag& Tag)
+	{
+		if (const int32* Index = TagIndexes.Find(Tag)) return *Index;
+
+		const int32 Index = Tags.Add(Tag);
+		TagIndexes.Add(Tag, Index);
+		Lineages.AddDefaulted();
+
+		// родители регистрируются рекурсивно, Lineages может переложиться, поэтому собираем во временный массив
+		TArray<int32, TInlineAllocator<4>> Lineage;
+		Lineage.Add(Index);
+		if (const FGameplayTag Parent = Tag.RequestDirectParent(); Parent.IsValid())
+		{
+			const int32 ParentIndex = RegisterTag(Parent);
+			Lineage.Append(Lineages[ParentIndex]);
+		}
+		Lineages[Index] = MoveTemp(Lineage);
+		return Index;
+	}
+
+	void Initialize()
+	{
+		bInitialized = true;
+		FGameplayTagContainer AllTags;
+		UGameplayTagsManager::Get().RequestAllGameplayTags(AllTags, false);
+		Tags.Reserve(AllTags.Num());
+		for (const FGameplayTag& Tag : AllTags) RegisterTag(Tag);
+	}
+}
+
+int32 FDASTagRegistry::GetTagIndex(const FGameplayTag& Tag)
+{
+	using namespace DASTagRegistry;
+	check(IsInGameThread())
+	if (!Tag.IsValid()) return INDEX_NONE;
+	if (!bInitialized) Initialize();
+	return RegisterTag(Tag);
+}
+
+TConstArrayView<int32> FDASTagRegistry::GetTagLineage(const int32 TagIndex)
+{
+	return DASTagRegistry::Lineages[TagIndex];
+}
+
+FGameplayTag FDASTagRegistry::GetTag(const int32 TagIndex)
+{
+	return DASTagRegistry::Tags[TagIndex];
+}
+
+void FDASTagSet::AddTagIndex(const int32 TagIndex)
+{
+	SetBit(ExplicitWords, TagIndex);
+	for (const int32 Index : FDASTagRegistry::GetTagLineage(TagIndex)) SetBit(MatchWords, Index);
+}
+
+void FDASTagSet::RebuildMatchWords()
+{
+	MatchWords.Reset();
+	for (int32 WordIndex = 0; WordIndex < ExplicitWords.Num(); ++WordIndex)
+	{
+		for (uint64 Word = ExplicitWords[WordIndex]; Word; Word &= Word - 1)
+		{
+			const int32 TagIndex = WordIndex * 64 + FMath::CountTrailingZeros64(Word);
+			for (const int32 Index : FDASTagRegistry::GetTagLineage(TagIndex)) SetBit(MatchWords, Index);
+		}
+	}
+}
+
+void FDASTagSet::AddTag(const FGameplayTag& Tag)
+{
+	if (const int32 TagIndex = FDASTagRegistry::GetTagIndex(Tag); TagIndex != INDEX_NONE) AddTagIndex(TagIndex);
+}
+
+void FDASTagSet::RemoveTag(const FGameplayTag& Tag)
+{
+	const int32 TagIndex = FDASTagRegistry::GetTagIndex(Tag);
+	if (!TestBit(ExplicitWords, TagIndex)) return;
+	ClearBit(ExplicitWords, TagIndex);
+	RebuildMatchWords();
+}
+
+void FDASTagSet::AppendTags(const FGameplayTagContainer& Container)
+{
+	for (const FGameplayTag& Tag : Container) AddTag(Tag);
+}
+
+void FDASTagSet::AppendTags(const FDASTagSet& Other)
+{
+	if (ExplicitWords.Num() < Other.ExplicitWords.Num()) ExplicitWords.SetNumZeroed(Other.ExplicitWords.Num());
+	if (MatchWords.Num() < Other.MatchWords.Num()) MatchWords.SetNumZeroed(Other.MatchWords.Num());
+	for (int32 Index = 0; Index < Other.ExplicitWords.Num(); ++Index) ExplicitWords[Index] |= Other.ExplicitWords[Index];
+	for (int32 Index = 0; Index < Other.MatchWords.Num(); ++Index) MatchWords[Index] |= Other.MatchWords[Index];
+}
+
+void FDASTagSet::RemoveTags(const FDASTagSet& Other)
+{
+	const int32 WordCount = FMath::Min(ExplicitWords.Num(), Other.ExplicitWords.Num());
+	uint64 Removed = 0;
+	for (int32 Index = 0; Index < WordCount; ++Index)
+	{
+		Removed |= ExplicitWords[Index] & Other.ExplicitWords[Index];
+		ExplicitWords[Index] &= ~Other.ExplicitWords[Index];
+	}
+	if (Removed) RebuildMatchWords();
+}
+
+bool FDASTagSet::IsEmpty() const
+{
+	uint64 Any = 0;
+	for (const uint64 Word : ExplicitWords) Any |= Word;
+	return Any == 0;
+}
+
+FGameplayTagContainer FDASTagSet::ToContainer() const
+{
+	FGameplayTagContainer Container;
+	for (int32 WordIndex = 0; WordIndex < ExplicitWords.Num(); ++WordIndex)
+	{
+		for (uint64 Word = ExplicitWords[WordIndex]; Word; Word &= Word - 1)
+		{
+			Container.AddTagFast(FDASTagRegistry::GetTag(WordIndex * 64 + FMath::CountTrailingZeros64(Word)));
+		}
+	}
+	return Container;
+}
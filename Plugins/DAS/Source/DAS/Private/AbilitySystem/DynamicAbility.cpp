@@ -1,12 +1,37 @@
 ﻿
 #include "AbilitySystem/DynamicAbility.h"
 #include "AbilitySystem/DynamicAbilitySystem.h"
+#include "AbilitySystem/SharedAbilitySettings.h"
+
+const FGameplayTag& UDynamicAbility::GetCurrentSlideTag() const
+{
+	return SharedSettings->GetSlideTag(CurrentSlideId);
+}
+
+void UDynamicAbility::ResetPooledState()
+{
+	Owner = nullptr;
+	AbilitySystem = nullptr;
+	CurrentSlideId = FSharedAbilitySettings::BaseSlideId;
+	SharedSettings.Reset();
+	SlideOverrides.Reset();
+	AbilityFlags.Reset();
+	AbilityState = EAbilityState::Inactive;
+	RunningTasks.Reset();
+	AbilityHandle = FAbilityHandle();
+	ResetAbility();
+}
 
 bool UDynamicAbility::ChangeSlide(const FGameplayTag& NewSlideType)
 {
 	return AbilitySystem->ChangeAbilitySlide(this, NewSlideType);
 }
 
+FTickerTaskHandle UDynamicAbility::RunTask(FTickerTask&& Task)
+{
+	return AbilitySystem->RunAbilityTask(this, MoveTemp(Task));
+}
+
 UAttribute* UDynamicAbility::GetAttribute(const TSubclassOf<UAttribute>& AttributeClass) const
 {
 	return AbilitySystem->GetAttribute(this, AttributeClass);
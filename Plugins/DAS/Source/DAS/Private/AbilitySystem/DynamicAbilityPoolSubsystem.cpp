@@ -0,0 +1,106 @@
+﻿
+#include "AbilitySystem/DynamicAbilityPoolSubsystem.h"
+#include "AbilitySystem/DynamicAbilitySystem.h"
+#include "HAL/IConsoleManager.h"
+
+bool UDynamicAbilityPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FDynamicAbilityPool& UDynamicAbilityPoolSubsystem::FindOrAddPool(const TSubclassOf<UDynamicAbility>& AbilityClass)
+{
+	if (FDynamicAbilityPool* Pool = Pools.Find(AbilityClass)) return *Pool;
+
+	FDynamicAbilityPool& Pool = Pools.Add(AbilityClass);
+	Pool.MaxSize = DefaultMaxPoolSize;
+	for (const FDynamicAbilityPoolClassSettings& Settings : ClassSettings)
+	{
+		if (Settings.AbilityClass.Get() != AbilityClass || Settings.MaxPoolSize == INDEX_NONE) continue;
+		Pool.MaxSize = Settings.MaxPoolSize;
+		break;
+	}
+	return Pool;
+}
+
+void UDynamicAbilityPoolSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	for (const FDynamicAbilityPoolClassSettings& Settings : ClassSettings)
+	{
+		if (Settings.PrewarmCount <= 0) continue;
+		if (const TSubclassOf<UDynamicAbility> AbilityClass = Settings.AbilityClass.LoadSynchronous())
+		{
+			PrewarmPool(AbilityClass, Settings.PrewarmCount);
+		}
+		else UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot prewarm ability pool, class '%s' could not be loaded"), *Settings.AbilityClass.ToString());
+	}
+}
+
+void UDynamicAbilityPoolSubsystem::Deinitialize()
+{
+	LogPoolStats();
+	Pools.Empty();
+	Super::Deinitialize();
+}
+
+UDynamicAbility* UDynamicAbilityPoolSubsystem::BorrowAbility(const TSubclassOf<UDynamicAbility>& AbilityClass)
+{
+	FDynamicAbilityPool& Pool = FindOrAddPool(AbilityClass);
+	if (!Pool.FreeAbilities.IsEmpty())
+	{
+		++Pool.Stats.Hits;
+		return Pool.FreeAbilities.Pop(EAllowShrinking::No);
+	}
+	++Pool.Stats.Misses;
+	return NewObject<UDynamicAbility>(this, AbilityClass);
+}
+
+void UDynamicAbilityPoolSubsystem::ReturnAbility(UDynamicAbility* Ability)
+{
+	check(Ability)
+	FDynamicAbilityPool& Pool = FindOrAddPool(Ability->GetClass());
+	if (Pool.FreeAbilities.Num() >= Pool.MaxSize || Ability->GetOuter() != this) // чужие экземпляры в пул не берём, их outer - система
+	{
+		++Pool.Stats.Discards;
+		return;
+	}
+	Ability->ResetPooledState();
+	Pool.FreeAbilities.Add(Ability);
+	++Pool.Stats.Returns;
+}
+
+void UDynamicAbilityPoolSubsystem::PrewarmPool(const TSubclassOf<UDynamicAbility>& AbilityClass, const int32 Count)
+{
+	FDynamicAbilityPool& Pool = FindOrAddPool(AbilityClass);
+	const int32 TargetCount = FMath::Min(Count, Pool.MaxSize);
+	Pool.FreeAbilities.Reserve(TargetCount);
+	while (Pool.FreeAbilities.Num() < TargetCount) Pool.FreeAbilities.Add(NewObject<UDynamicAbility>(this, AbilityClass));
+}
+
+const FDynamicAbilityPoolStats* UDynamicAbilityPoolSubsystem::GetPoolStats(const TSubclassOf<UDynamicAbility>& AbilityClass) const
+{
+	const FDynamicAbilityPool* Pool = Pools.Find(AbilityClass);
+	return Pool ? &Pool->Stats : nullptr;
+}
+
+void UDynamicAbilityPoolSubsystem::LogPoolStats() const
+{
+	for (const auto& [AbilityClass, Pool] : Pools)
+	{
+		UE_LOG(LogDynamicAbilitySystem, Log, TEXT("Ability pool '%s': hit rate %.1f%% (%d hits, %d misses), %d returns, %d discards, %d/%d free"),
+			*GetNameSafe(AbilityClass), Pool.Stats.GetHitRate() * 100.f, Pool.Stats.Hits, Pool.Stats.Misses,
+			Pool.Stats.Returns, Pool.Stats.Discards, Pool.FreeAbilities.Num(), Pool.MaxSize);
+	}
+}
+
+namespace DASAbilityPool
+{
+	static FAutoConsoleCommandWithWorld StatsCommand(
+		TEXT("DAS.AbilityPool.Stats"),
+		TEXT("Logs hit rate and size of every ability pool in the world"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](const UWorld* World)
+		{
+			if (const UDynamicAbilityPoolSubsystem* Pool = World ? World->GetSubsystem<UDynamicAbilityPoolSubsystem>() : nullptr) Pool->LogPoolStats();
+		}));
+}
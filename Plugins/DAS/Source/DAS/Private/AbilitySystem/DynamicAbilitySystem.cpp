@@ -1,7 +1,13 @@
 ﻿
 #include "AbilitySystem/DynamicAbilitySystem.h"
+#include "AbilitySystem/DynamicAbilityTickerSubsystem.h"
+#include "AbilitySystem/DynamicAbilityPoolSubsystem.h"
 #include "TickerModules/AbilityUpdateTickerModule.h"
 #include "TickerModules/FunHolderTickerModule.h"
+#include "TickerModules/SharedAbilityTickerModules.h"
+#include "TickerModules/AbilityCommandTickerModule.h"
+#include "CoroutineTickerModule.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
 DEFINE_LOG_CATEGORY(LogDynamicAbilitySystem);
 
@@ -22,51 +28,371 @@ void UDynamicAbilitySystem::BeginPlay()
 void UDynamicAbilitySystem::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
-	CurrentAbilities.Empty();
+
+	// выключаем до возврата в пул: отложенные функции и обновления способности не должны сработать после системы на чужом экземпляре
+	ForEachAbility([this](const FName&, UDynamicAbility* Ability)
+	{
+		if (Ability->AbilityState != EAbilityState::Inactive) DisableAbility(Ability, EDisableType::Removed, this, FGameplayTag::EmptyTag);
+		CancelAbilityTasks(Ability);
+	});
+	if (SharedTicker.IsValid()) SharedTicker->RemoveSystemTasks(this);
+	else
+	{
+		UnbindTickPhases();
+		StopTicker();
+	}
+	if (UDynamicAbilityPoolSubsystem* AbilityPool = GetAbilityPool())
+	{
+		ForEachAbility([AbilityPool](const FName&, UDynamicAbility* Ability) { AbilityPool->ReturnAbility(Ability); });
+	}
+	TagWaiters.Empty();
+	AbilityCommands.Empty();
+	GrantedTagAbilities.Empty();
+	InputSubscribers.Empty();
+	AbilitySlots.Empty();
+	FreeAbilitySlots.Empty();
+	AbilityHandles.Empty();
 	Attributes.Empty();
 }
 
 void UDynamicAbilitySystem::SetUpTickerManager()
 {
+	if (bUseSharedTicker)
+	{
+		SharedTicker = GetWorld()->GetSubsystem<UDynamicAbilityTickerSubsystem>();
+		if (SharedTicker.IsValid()) return;
+		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Shared ability ticker is not available in this world, falling back to the system ticker."));
+	}
 	AutoActivateTickerType = { ETickerStateType::GameUnPaused };
 	AutoDisableTickerType = { ETickerStateType::GamePaused };
+	// имя владельца только в трейсе, статы общие на класс системы, иначе каждый заспавненный актор заводит новые
+	TickerStatName = GetClass()->GetName();
+	TickerDebugName = FString::Printf(TEXT("%s.%s"), *GetNameSafe(GetOwner()), *TickerStatName);
+	SetTickerWorld(GetWorld());
+	bUseFixedTimeStep = bFixedTickerStep;
+	FixedTimeStep = 1.f / FMath::Max(TickerStepRate, 1.f);
+	MaxSubSteps = FMath::Max(TickerMaxSubSteps, 1);
+	FrameBudgetMicroseconds = TickerFrameBudget;
 
 	AddTickerModule<FFunHolderTickerModule>();
+	AddTickerModule<FCoroutineTickerModule>();
 	FAbilityUpdateTickerModule* AbilityUpdateTickerModule = AddTickerModule<FAbilityUpdateTickerModule>();
 	AbilityUpdateTickerModule->AbilityUpdateInvoker.Bind(this, &UDynamicAbilitySystem::UpdateAbility);
-	
-	AbilityUpdateTickerModule->DisableAbilityInvoker.Bind([this](const FName& Key){
-		const auto& AbilityStorage = CurrentAbilities.FindChecked(Key);
-		if (const auto Ability = AbilityStorage.Get(); !Ability->CurrentSlideType.IsValid()) // если на базовом слайде, то полностью выключаем способность
+	AbilityUpdateTickerModule->DisableAbilityInvoker.Bind(this, &UDynamicAbilitySystem::OnAbilityUpdateExpired);
+	AddTickerModule<FAbilityCommandTickerModule>();
+
+	if (bTickInPrePhysics)
+	{
+		SetModuleTickPhase(GetTickerModuleMutable<FAbilityCommandTickerModule>(), ETickerPhase::PrePhysics);
+		SetModuleTickPhase(GetTickerModuleMutable<FFunHolderTickerModule>(), ETickerPhase::PrePhysics);
+		SetModuleTickPhase(GetTickerModuleMutable<FCoroutineTickerModule>(), ETickerPhase::PrePhysics);
+		SetModuleTickPhase(AbilityUpdateTickerModule, ETickerPhase::PrePhysics);
+	}
+	BindTickPhases(GetWorld());
+}
+
+bool UDynamicAbilitySystem::AddAbilityTickPrerequisite(FTickFunction& DependentTickFunction)
+{
+	UObject* TickerOwner = SharedTicker.IsValid() ? static_cast<UObject*>(SharedTicker.Get()) : this;
+	FStaticTickerManager* Manager = SharedTicker.IsValid() ? static_cast<FStaticTickerManager*>(SharedTicker.Get()) : this;
+	FTickFunction* AbilityTickFunction = Manager->GetPhaseTickFunction(ETickerPhase::PrePhysics);
+	if (!AbilityTickFunction) return false;
+
+	DependentTickFunction.AddPrerequisite(TickerOwner, *AbilityTickFunction);
+	return true;
+}
+
+void UDynamicAbilitySystem::OnAbilityUpdateExpired(const FAbilityHandle& Handle)
+{
+	UDynamicAbility* Ability = FindAbility(Handle);
+	if (!Ability) return;
+	if (Ability->CurrentSlideId == FSharedAbilitySettings::BaseSlideId) // если на базовом слайде, то полностью выключаем способность
+	{
+		OnAbilityDisabled(Ability, EDisableType::End, this, FGameplayTag::EmptyTag);
+	}
+	else // если слайд кастомный, то сбрасываемся к базовому
+	{
+		ChangeAbilitySlideById(Ability, FSharedAbilitySettings::BaseSlideId);
+	}
+}
+
+TInvoker<void()>* UDynamicAbilitySystem::AddAbilityDelayedFun(const FAbilityHandle& Handle, const float DelaySeconds)
+{
+	if (SharedTicker.IsValid()) return SharedTicker->GetFunHolderModule()->AddDelayedFun(FAbilityTickerKey(this, Handle), DelaySeconds);
+	return GetTickerModuleMutable<FFunHolderTickerModule>()->AddDelayedFun(Handle, DelaySeconds);
+}
+
+void UDynamicAbilitySystem::RemoveAbilityDelayedFun(const FAbilityHandle& Handle)
+{
+	if (SharedTicker.IsValid()) SharedTicker->GetFunHolderModule()->RemoveDelayedFun(FAbilityTickerKey(this, Handle));
+	else GetTickerModuleMutable<FFunHolderTickerModule>()->RemoveDelayedFun(Handle);
+}
+
+void UDynamicAbilitySystem::ReSetAbilityUpdate(const FAbilityHandle& Handle, const float UpdateRate, const float MaxActiveTime)
+{
+	if (SharedTicker.IsValid()) SharedTicker->GetAbilityUpdateModule()->ReSetAbilityUpdate(FAbilityTickerKey(this, Handle), UpdateRate, MaxActiveTime);
+	else GetTickerModuleMutable<FAbilityUpdateTickerModule>()->ReSetAbilityUpdate(Handle, UpdateRate, MaxActiveTime);
+}
+
+void UDynamicAbilitySystem::EndAbilityUpdate(const FAbilityHandle& Handle)
+{
+	if (SharedTicker.IsValid()) SharedTicker->GetAbilityUpdateModule()->EndUpdateAbility(FAbilityTickerKey(this, Handle));
+	else GetTickerModuleMutable<FAbilityUpdateTickerModule>()->EndUpdateAbility(Handle);
+}
+
+TOptional<FUpdateAbilityTickerData> UDynamicAbilitySystem::GetAbilityUpdateTask(const FAbilityHandle& Handle) const
+{
+	if (SharedTicker.IsValid())
+	{
+		// ключ общего модуля хранит неконстантный указатель на систему, сам модуль его не изменяет
+		return SharedTicker->GetAbilityUpdateModule()->GetUpdateTask(FAbilityTickerKey(const_cast<UDynamicAbilitySystem*>(this), Handle));
+	}
+	const auto* Module = GetTickerModule<FAbilityUpdateTickerModule>();
+	return Module ? Module->GetUpdateTask(Handle) : TOptional<FUpdateAbilityTickerData>();
+}
+
+FCoroutineTickerModule* UDynamicAbilitySystem::GetAbilityCoroutineModule()
+{
+	if (SharedTicker.IsValid()) return SharedTicker->GetCoroutineModule();
+	return GetTickerModuleMutable<FCoroutineTickerModule>();
+}
+
+FAbilityCommandTickerModule* UDynamicAbilitySystem::GetAbilityCommandModule()
+{
+	if (SharedTicker.IsValid()) return SharedTicker->GetCommandModule();
+	return GetTickerModuleMutable<FAbilityCommandTickerModule>();
+}
+
+bool UDynamicAbilitySystem::QueueAbilityCommand(FAbilityCommand&& Command)
+{
+	FAbilityCommandTickerModule* Module = GetAbilityCommandModule();
+	if (!Module)
+	{
+		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot queue ability command because ticker is not set up"));
+		return false;
+	}
+	if (AbilityCommands.IsEmpty()) Module->AddPendingSystem(this);
+	AbilityCommands.Add(MoveTemp(Command));
+	return true;
+}
+
+void UDynamicAbilitySystem::ResolveAbilityCommands()
+{
+	if (AbilityCommands.IsEmpty()) return;
+	TRACE_CPUPROFILER_EVENT_SCOPE(UDynamicAbilitySystem::ResolveAbilityCommands);
+
+	// команды, поставленные способностями во время разбора, попадут в следующую пачку
+	Swap(AbilityCommands, ResolvingAbilityCommands);
+	ResolvingAbilityCommands.StableSort([](const FAbilityCommand& A, const FAbilityCommand& B)
+	{
+		return A.Type == EAbilityCommandType::Disable && B.Type != EAbilityCommandType::Disable;
+	});
+	bResolvingAbilityCommands = true;
+
+	// инициатор мог быть удалён, пока команда ждала в очереди, тогда инициатором считается система
+	const auto GetInstigator = [this](const FAbilityCommand& Command) -> const UObject*
+	{
+		const UObject* Instigator = Command.Instigator.Get();
+		return Instigator ? Instigator : this;
+	};
+
+	// выключения не проверяют теги, поэтому идут до снимка и освобождают теги для активаций этой же пачки
+	int32 Index = 0;
+	for (; Index < ResolvingAbilityCommands.Num() && ResolvingAbilityCommands[Index].Type == EAbilityCommandType::Disable; ++Index)
+	{
+		const FAbilityCommand& Command = ResolvingAbilityCommands[Index];
+		if (UDynamicAbility* Ability = FindAbility(Command.Handle)) DisableAbility(Ability, EDisableType::Forced, GetInstigator(Command), Command.DisableReason);
+	}
+
+	TagSnapshot = OwnedTags.GetTagSet();
+	bUseTagSnapshot = true;
+	for (; Index < ResolvingAbilityCommands.Num(); ++Index)
+	{
+		const FAbilityCommand& Command = ResolvingAbilityCommands[Index];
+		UDynamicAbility* Ability = FindAbility(Command.Handle);
+		if (!Ability) continue; // способность удалили, пока команда ждала в очереди
+		if (Command.Type == EAbilityCommandType::Slide) ChangeAbilitySlideById(Ability, Command.SlideId);
+		else TryActivateAbility(Ability, GetInstigator(Command));
+	}
+	bUseTagSnapshot = false;
+
+	OverrideAbilities(BatchActivations);
+	BatchActivations.Reset();
+	ResolvingAbilityCommands.Reset();
+	bResolvingAbilityCommands = false;
+}
+
+FTickerTaskHandle UDynamicAbilitySystem::RunAbilityTask(UDynamicAbility* Ability, FTickerTask&& Task)
+{
+	check(Ability)
+	FCoroutineTickerModule* Module = GetAbilityCoroutineModule();
+	if (!Module)
+	{
+		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot run task of ability '%s' because ticker is not set up"), *Ability->GetName());
+		return FTickerTaskHandle();
+	}
+	Ability->RunningTasks.RemoveAllSwap([Module](const FTickerTaskHandle& Handle) { return !Module->IsTaskRunning(Handle); });
+
+	const FTickerTaskHandle Handle = Module->Launch(MoveTemp(Task));
+	if (Handle.IsValid()) Ability->RunningTasks.Add(Handle);
+	return Handle;
+}
+
+void UDynamicAbilitySystem::EnqueueAbilityDelayedFun(const FAbilityHandle& Handle, const float DelaySeconds, TInvoker<void()>&& Fun)
+{
+	// очередь есть у менеджера системы и при общем тикере, команда сама выберет нужный модуль на игровом потоке
+	EnqueueCommand([WeakThis = TWeakObjectPtr<UDynamicAbilitySystem>(this), Handle, DelaySeconds, Fun = MoveTemp(Fun)]() mutable
+	{
+		UDynamicAbilitySystem* System = WeakThis.Get();
+		if (!System || !System->FindAbility(Handle)) return; // способность могли удалить, пока команда ждала в очереди
+		if (TInvoker<void()>* Task = System->AddAbilityDelayedFun(Handle, DelaySeconds)) *Task = MoveTemp(Fun);
+	});
+}
+
+void UDynamicAbilitySystem::EnqueueAbilityUpdate(const FAbilityHandle& Handle, const float UpdateRate, const float MaxActiveTime)
+{
+	EnqueueCommand([WeakThis = TWeakObjectPtr<UDynamicAbilitySystem>(this), Handle, UpdateRate, MaxActiveTime]
+	{
+		UDynamicAbilitySystem* System = WeakThis.Get();
+		if (System && System->FindAbility(Handle)) System->ReSetAbilityUpdate(Handle, UpdateRate, MaxActiveTime);
+	});
+}
+
+void UDynamicAbilitySystem::CancelAbilityTasks(UDynamicAbility* Ability)
+{
+	if (Ability->RunningTasks.IsEmpty()) return;
+	if (FCoroutineTickerModule* Module = GetAbilityCoroutineModule())
+	{
+		for (const FTickerTaskHandle& Handle : Ability->RunningTasks) Module->Cancel(Handle);
+	}
+
+	// ожидания тегов отменённых корутин иначе висели бы до появления тега или EndPlay
+	TagWaiters.RemoveAllSwap([Ability](const FTagWaiter& Waiter) { return Ability->RunningTasks.Contains(Waiter.Handle); }, EAllowShrinking::No);
+	Ability->RunningTasks.Reset();
+}
+
+void UDynamicAbilitySystem::AddOwnedTags(const FDASTagSet& Tags)
+{
+	OwnedTags.AddTags(Tags, [this](const FGameplayTag& Tag, const bool bAdded) { OnOwnedTagChanged(Tag, bAdded); });
+}
+
+void UDynamicAbilitySystem::RemoveOwnedTags(const FDASTagSet& Tags)
+{
+	OwnedTags.RemoveTags(Tags, [this](const FGameplayTag& Tag, const bool bAdded) { OnOwnedTagChanged(Tag, bAdded); });
+}
+
+void UDynamicAbilitySystem::GrantAbilityTags(const UDynamicAbility* Ability, const FDASTagSet& Tags)
+{
+	AddOwnedTags(Tags);
+	IndexAbilityTags(Ability, Tags);
+}
+
+void UDynamicAbilitySystem::RevokeAbilityTags(const UDynamicAbility* Ability, const FDASTagSet& Tags)
+{
+	RemoveOwnedTags(Tags);
+	UnindexAbilityTags(Ability, Tags);
+}
+
+void UDynamicAbilitySystem::IndexAbilityTags(const UDynamicAbility* Ability, const FDASTagSet& Tags)
+{
+	Tags.ForEachExplicitIndex([&](const int32 TagIndex)
+	{
+		for (const int32 Index : FDASTagRegistry::GetTagLineage(TagIndex))
 		{
-			OnAbilityDisabled(Ability, EDisableType::End, this, FGameplayTag::EmptyTag);
+			if (GrantedTagAbilities.Num() <= Index) GrantedTagAbilities.SetNum(Index + 1);
+			GrantedTagAbilities[Index].Add(Ability->AbilityHandle);
 		}
-		else // если слайд кастомный, то сбрасываемся к базовому
+	});
+}
+
+void UDynamicAbilitySystem::UnindexAbilityTags(const UDynamicAbility* Ability, const FDASTagSet& Tags)
+{
+	Tags.ForEachExplicitIndex([&](const int32 TagIndex)
+	{
+		for (const int32 Index : FDASTagRegistry::GetTagLineage(TagIndex))
 		{
-			ChangeAbilitySlide(Ability, FGameplayTag::EmptyTag);
+			if (GrantedTagAbilities.IsValidIndex(Index)) GrantedTagAbilities[Index].RemoveSingleSwap(Ability->AbilityHandle, EAllowShrinking::No);
 		}
 	});
 }
+
+void UDynamicAbilitySystem::OnOwnedTagChanged(const FGameplayTag& Tag, const bool bAdded)
+{
+	if (bAdded)
+	{
+		for (int32 Index = TagWaiters.Num() - 1; Index >= 0; --Index)
+		{
+			if (TagWaiters[Index].Tag != Tag) continue;
+			TagWaiters[Index].Module->Resume(TagWaiters[Index].Handle);
+			TagWaiters.RemoveAtSwap(Index, EAllowShrinking::No);
+		}
+	}
+	OnOwnedTagChangedDelegate.Broadcast(Tag, bAdded);
+}
+
+bool FAbilityTagAddedAwaiter::await_ready() const
+{
+	check(System)
+	return System->OwnedTags.HasTag(Tag);
+}
+
+void FAbilityTagAddedAwaiter::await_suspend(FTickerTask::FHandle Coroutine) const
+{
+	const auto& Promise = Coroutine.promise();
+	System->TagWaiters.Add({ Tag, Promise.Module, Promise.Handle });
+}
 	
-bool UDynamicAbilitySystem::AddAbility(const FName Key, const TSubclassOf<UDynamicAbility>& AbilityClass, const UObject* Adder)
+FAbilityHandle UDynamicAbilitySystem::AddAbility(const FName Key, const TSubclassOf<UDynamicAbility>& AbilityClass, const UObject* Adder)
 {
-	if (!ValidateAbilityAddition(Key, AbilityClass, Adder)) return false;
-	if (auto Ability = NewObject<UDynamicAbility>(this, AbilityClass))
+	if (!ValidateAbilityAddition(Key, AbilityClass, Adder)) return FAbilityHandle();
+	UDynamicAbilityPoolSubsystem* AbilityPool = GetAbilityPool();
+	if (auto Ability = AbilityPool ? AbilityPool->BorrowAbility(AbilityClass) : NewObject<UDynamicAbility>(this, AbilityClass))
 	{
-		CurrentAbilities.Add(Key, TStrongObjectPtr(MoveTemp(Ability)));
+		const FAbilityHandle Handle = AllocateAbilitySlot(Key, Ability);
 		OnAbilityAdded(Key, Ability, Adder);
 		
-		if (Ability->AbilitySettings.ActivateAbilityOnGranted) ActivateAbility(Key, Adder);
-		return true;
+		if (Ability->SharedSettings->bActivateAbilityOnGranted) ActivateAbility(Handle, Adder);
+		return Handle;
 	}
 	UE_LOG(LogDynamicAbilitySystem, Error, TEXT("Failed to create ability object of name '%s'."), *Key.ToString());
-	return false;
+	return FAbilityHandle();
+}
+
+UDynamicAbilityPoolSubsystem* UDynamicAbilitySystem::GetAbilityPool() const
+{
+	if (!bUseAbilityPool) return nullptr;
+	const UWorld* World = GetWorld();
+	return World ? World->GetSubsystem<UDynamicAbilityPoolSubsystem>() : nullptr;
+}
+
+FAbilityHandle UDynamicAbilitySystem::AllocateAbilitySlot(const FName Key, UDynamicAbility* Ability)
+{
+	const int32 Index = !FreeAbilitySlots.IsEmpty() ? FreeAbilitySlots.Pop(EAllowShrinking::No) : AbilitySlots.AddDefaulted();
+	FAbilitySlot& Slot = AbilitySlots[Index];
+	Slot.Ability = TStrongObjectPtr(Ability);
+	Slot.Key = Key;
+
+	const FAbilityHandle Handle{ Index, Slot.Serial };
+	Ability->AbilityHandle = Handle;
+	AbilityHandles.Add(Key, Handle);
+	return Handle;
+}
+
+void UDynamicAbilitySystem::ReleaseAbilitySlot(const FAbilityHandle& Handle)
+{
+	if (!FindAbility(Handle)) return;
+	FAbilitySlot& Slot = AbilitySlots[Handle.Index];
+	AbilityHandles.Remove(Slot.Key);
+	Slot.Ability.Reset();
+	Slot.Key = NAME_None;
+	++Slot.Serial; // старые хендлы и задачи тикера по ним больше не разрешаются в способность
+	FreeAbilitySlots.Add(Handle.Index);
 }
 bool UDynamicAbilitySystem::ValidateAbilityAddition(const FName Key, const TSubclassOf<UDynamicAbility>& AbilityClass, const UObject* Adder) const
 {
 	if (!Adder) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to add ability class '%s', but adder was invalid"), *AbilityClass->GetName());
 	if (Key == NAME_None) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to add ability class '%s', but this ability has invalid name 'None'."), *AbilityClass->GetName());
-	if (CurrentAbilities.Contains(Key))
+	if (AbilityHandles.Contains(Key))
 	{
 		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Attempted to add ability '%s', but this ability has already been added."), *Key.ToString());
 		return false;
@@ -84,67 +410,96 @@ void UDynamicAbilitySystem::OnAbilityAdded(const FName Key, UDynamicAbility* Abi
 
 bool UDynamicAbilitySystem::RemoveAbility(const FName Key, const UObject* Remover)
 {
-	if (!Remover) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to Remove ability, but Remover has invalid."));
 	if (Key == NAME_None) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to Remove ability, but ability name has invalid 'None'."));
-	if (const auto AbilityStorage = CurrentAbilities.Find(Key))
+	if (const FAbilityHandle Handle = FindAbilityHandle(Key); Handle.IsValid()) return RemoveAbility(Handle, Remover);
+	UE_LOG(LogDynamicAbilitySystem, Error, TEXT("Cannot remove ability '%s' because it was not added."), *Key.ToString());
+	return false;
+}
+
+bool UDynamicAbilitySystem::RemoveAbility(const FAbilityHandle& Handle, const UObject* Remover)
+{
+	if (!Remover) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to Remove ability, but Remover has invalid."));
+	if (const auto Ability = FindAbility(Handle))
 	{
-		const auto Ability = AbilityStorage->Get();
-		
 		DisableAbility(Ability, EDisableType::Removed, Remover, FGameplayTag::EmptyTag);
-		OnRemovedAbility.Broadcast(Key);
+		OnRemovedAbility.Broadcast(AbilitySlots[Handle.Index].Key);
 		Ability->OnAbilityRemoved(Remover);
-		CurrentAbilities.Remove(Key);
+		ReleaseAbilitySlot(Handle);
+		if (UDynamicAbilityPoolSubsystem* AbilityPool = GetAbilityPool()) AbilityPool->ReturnAbility(Ability);
 		return true;
 	}
-	UE_LOG(LogDynamicAbilitySystem, Error, TEXT("Cannot remove ability '%s' because it was not added."), *Key.ToString());
+	UE_LOG(LogDynamicAbilitySystem, Error, TEXT("Cannot remove ability with handle %d:%u because it was already removed."), Handle.Index, Handle.Serial);
 	return false;
 }
 
 bool UDynamicAbilitySystem::ActivateAbility(const FName Key, const UObject* Activator)
 {
 	if (Key == NAME_None) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to activate ability, but this ability has invalid name 'None'."));
+	if (const FAbilityHandle Handle = FindAbilityHandle(Key); Handle.IsValid()) return ActivateAbility(Handle, Activator);
+	UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Attempted to activate ability '%s', but it could not be found"), *Key.ToString());
+	return false;
+}
+
+bool UDynamicAbilitySystem::ActivateAbility(const FAbilityHandle& Handle, const UObject* Activator)
+{
 	if (!Activator) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to activate ability, but adder was invalid"));
-	if (const auto AbilityContainer = CurrentAbilities.Find(Key))
+	if (const auto Ability = FindAbility(Handle))
 	{
-		auto Ability = AbilityContainer->Get();
-		if (Ability->AbilityState == EAbilityState::Inactive)
+		if (bQueueAbilityCommands) return QueueAbilityCommand({ EAbilityCommandType::Activate, Handle, INDEX_NONE, Activator });
+		return TryActivateAbility(Ability, Activator);
+	}
+	UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Attempted to activate ability with handle %d:%u, but it was already removed"), Handle.Index, Handle.Serial);
+	return false;
+}
+
+bool UDynamicAbilitySystem::TryActivateAbility(UDynamicAbility* Ability, const UObject* Activator)
+{
+	if (Ability->AbilityState == EAbilityState::Inactive)
+	{
+		if (!ValidateSlideChange(GetSlideData(Ability, FSharedAbilitySettings::BaseSlideId))) return false;
+		if (!Ability->ValidateAbilityActivation(Activator)) return false;
+		
+		const float ActivationDelay = GetSlideTimings(Ability, FSharedAbilitySettings::BaseSlideId).ActivationDelay;
+		if (ActivationDelay == 0.f) OnAbilityActivated(Ability, Activator);
+		else
 		{
-			const auto Settings = FindSlideData(Ability, ESlideSettingsType::Auto);
-			if (!ValidateSlideChange(*Settings)) return false;
-			if (!Ability->ValidateAbilityActivation(Activator)) return false;
-			
-			if (Settings->ActivationDelay == 0.f) OnAbilityActivated(Ability, Activator);
-			else
+			Ability->AbilityState = EAbilityState::Activating;
+			// теги выдаются только после задержки, но в индекс попадают сразу, чтобы замена других способностей отменяла и замах
+			IndexAbilityTags(Ability, GetSlideData(Ability, FSharedAbilitySettings::BaseSlideId).SlideTagSet);
+			Ability->AbilityFlags.Add(EAbilityFlag::TagsIndexed);
+			if (bResolvingAbilityCommands) BatchActivations.Add({ Ability->AbilityHandle, false });
+			AddAbilityDelayedFun(Ability->AbilityHandle, ActivationDelay)->Bind([this, Handle = Ability->AbilityHandle, Activator]
 			{
-				Ability->AbilityState = EAbilityState::Activating;
-				GetTickerModuleMutable<FFunHolderTickerModule>()->AddDelayedFun(Key, Settings->ActivationDelay)->Bind([this, Ability, Activator]
-				{
-					OnAbilityActivated(Ability, Activator);
-				});
-			}
-			return true;
+				if (UDynamicAbility* DelayedAbility = FindAbility(Handle)) OnAbilityActivated(DelayedAbility, Activator);
+			});
 		}
-		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot activate ability '%s' because it is already active."), *Ability->GetName());
+		return true;
 	}
-	UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Attempted to activate ability '%s', but it could not be found"), *Key.ToString());
+	UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot activate ability '%s' because it is already active."), *Ability->GetName());
 	return false;
-
 }
 
 void UDynamicAbilitySystem::OnAbilityActivated(UDynamicAbility* Ability, const UObject* Activator)
 {
-	const auto Settings = FindSlideData(Ability, ESlideSettingsType::Auto);
 	Ability->AbilityState = EAbilityState::Active;
-	OwnedTags.AppendTags(Settings->SlideTags);
-	OverrideAbilities(Ability);
+	const FDASTagSet& BaseTags = GetSlideData(Ability, FSharedAbilitySettings::BaseSlideId).SlideTagSet;
+	if (Ability->AbilityFlags.Contains(EAbilityFlag::TagsIndexed)) AddOwnedTags(BaseTags); // в индексе с начала задержки активации
+	else GrantAbilityTags(Ability, BaseTags);
+	Ability->AbilityFlags.Add(EAbilityFlag::TagsIndexed);
+	Ability->AbilityFlags.Add(EAbilityFlag::TagsGranted);
+	SubscribeAbilityInputs(Ability);
+	if (bResolvingAbilityCommands) BatchActivations.Add({ Ability->AbilityHandle, true }); // замена пройдёт одним проходом после пачки
+	else OverrideAbilities(Ability);
 	Ability->OnAbilityActivated(Activator);
-	
-	if (Settings->UpdateAbilityRate != 0.f || Settings->bTickEveryFrame)
-	{
-		Ability->AbilityFlags.Add(EAbilityFlag::Updating);
-		const auto UpdateRate = Settings->bTickEveryFrame ? 0.f : Settings->UpdateAbilityRate;
-		GetTickerModuleMutable<FAbilityUpdateTickerModule>()->ReSetAbilityUpdate(Ability->AbilityName, UpdateRate, Settings->MaxActiveTime);
-	}
+	StartSlideUpdate(Ability, GetSlideTimings(Ability, FSharedAbilitySettings::BaseSlideId));
+}
+
+void UDynamicAbilitySystem::StartSlideUpdate(UDynamicAbility* Ability, const FAbilitySlideTimings& Timings)
+{
+	if (Timings.UpdateAbilityRate == 0.f && !Timings.bTickEveryFrame) return;
+	Ability->AbilityFlags.Add(EAbilityFlag::Updating);
+	const auto UpdateRate = Timings.bTickEveryFrame ? 0.f : Timings.UpdateAbilityRate;
+	ReSetAbilityUpdate(Ability->AbilityHandle, UpdateRate, Timings.MaxActiveTime);
 }
 
 bool UDynamicAbilitySystem::DisableAbility(UDynamicAbility* Ability, const EDisableType& DisableType, const UObject* Disabler, const FGameplayTag& DisableReason)
@@ -153,8 +508,8 @@ bool UDynamicAbilitySystem::DisableAbility(UDynamicAbility* Ability, const EDisa
 	if (!Disabler) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to disable ability, but disabler was invalid"));
 	if (Ability->AbilityState != EAbilityState::Inactive)
 	{
-		if (Ability->AbilityState == EAbilityState::Activating) GetTickerModuleMutable<FFunHolderTickerModule>()->RemoveDelayedFun(Ability->AbilityName);
-		else if (Ability->AbilityFlags.Contains(EAbilityFlag::Updating)) GetTickerModuleMutable<FAbilityUpdateTickerModule>()->EndUpdateAbility(Ability->AbilityName);
+		if (Ability->AbilityState == EAbilityState::Activating) RemoveAbilityDelayedFun(Ability->AbilityHandle);
+		else if (Ability->AbilityFlags.Contains(EAbilityFlag::Updating)) EndAbilityUpdate(Ability->AbilityHandle);
 
 		OnAbilityDisabled(Ability, DisableType, Disabler, DisableReason);
 		return true;
@@ -164,55 +519,76 @@ bool UDynamicAbilitySystem::DisableAbility(UDynamicAbility* Ability, const EDisa
 }
 void UDynamicAbilitySystem::OnAbilityDisabled(UDynamicAbility* Ability, const EDisableType& DisableType, const UObject* Disabler, const FGameplayTag& DisableReason)
 {
-	// сбрасываем настройки менеджера
-	OwnedTags.RemoveTags(FindSlideData(Ability, ESlideSettingsType::Base, true)->SlideTags);
-	if (Ability->CurrentSlideType.IsValid()) // дополнительно очищаем от тегов слайда
+	// сбрасываем настройки менеджера, теги снимаем только если способность их выдала, иначе уменьшим счётчики чужих тегов
+	const FDASTagSet& BaseTags = GetSlideData(Ability, FSharedAbilitySettings::BaseSlideId).SlideTagSet;
+	if (Ability->AbilityFlags.Contains(EAbilityFlag::TagsGranted))
 	{
-		OwnedTags.RemoveTags(FindSlideData(Ability, ESlideSettingsType::Current)->SlideTags);
+		UnsubscribeAbilityInputs(Ability);
+		RemoveOwnedTags(BaseTags);
+		if (Ability->CurrentSlideId != FSharedAbilitySettings::BaseSlideId) // дополнительно очищаем от тегов слайда
+		{
+			RevokeAbilityTags(Ability, GetCurrentSlideData(Ability).SlideTagSet);
+		}
 	}
+	if (Ability->AbilityFlags.Contains(EAbilityFlag::TagsIndexed)) UnindexAbilityTags(Ability, BaseTags); // в том числе выключение во время задержки активации
 
 	// сбрасываем настройки способности
+	CancelAbilityTasks(Ability);
 	Ability->AbilityFlags.Remove(EAbilityFlag::Updating);
-	Ability->CurrentSlideType = FGameplayTag::EmptyTag;
+	Ability->AbilityFlags.Remove(EAbilityFlag::TagsGranted);
+	Ability->AbilityFlags.Remove(EAbilityFlag::TagsIndexed);
+	Ability->CurrentSlideId = FSharedAbilitySettings::BaseSlideId;
 	Ability->AbilityState = EAbilityState::Inactive;
 	Ability->OnAbilityDisabled(DisableType, DisableReason, Disabler);
 }
 
-bool UDynamicAbilitySystem::UpdateAbility(const FName& Key, const float DeltaTime)
+bool UDynamicAbilitySystem::UpdateAbility(const FAbilityHandle& Handle, const float DeltaTime)
 {
-	if (const auto AbilityStorage = CurrentAbilities.Find(Key))
+	if (const auto Ability = FindAbility(Handle))
 	{
-		if (const auto Ability = AbilityStorage->Get())
+		if (const TOptional<FGameplayTag>& Reason = Ability->UpdateAbility(DeltaTime); Reason.IsSet())
 		{
-			if (const TOptional<FGameplayTag>& Reason = Ability->UpdateAbility(DeltaTime); Reason.IsSet())
+			if (Ability->CurrentSlideId == FSharedAbilitySettings::BaseSlideId) // если на базовом слайде, то полностью выключаем способность
+			{
+				OnAbilityDisabled(Ability, EDisableType::FromUpdate, this, Reason.GetValue());
+			}
+			else // если слайд кастомный, то сбрасываемся к базовому
 			{
-				if (!Ability->CurrentSlideType.IsValid()) // если на базовом слайде, то полностью выключаем способность
-				{
-					OnAbilityDisabled(Ability, EDisableType::FromUpdate, this, Reason.GetValue());
-				}
-				else // если слайд кастомный, то сбрасываемся к базовому
-				{
-					ChangeAbilitySlide(Ability, FGameplayTag::EmptyTag);
-				}
+				ChangeAbilitySlideById(Ability, FSharedAbilitySettings::BaseSlideId);
 			}
 		}
 		return true;
 	}
-	UE_LOG(LogDynamicAbilitySystem, Error, TEXT("Cannot update ability '%s'"), *Key.ToString());
+	UE_LOG(LogDynamicAbilitySystem, Error, TEXT("Cannot update ability with handle %d:%u because it was removed"), Handle.Index, Handle.Serial);
 	return false;
 }
 
 bool UDynamicAbilitySystem::ValidateSlideChange(const FAbilitySlideSettings& SlideSettings) const
 {
-	if (OwnedTags.HasAny(SlideSettings.SlideTags)) return false;
-	if (OwnedTags.HasAny(SlideSettings.ActivationBlockedTags)) return false;
-	if (!SlideSettings.ActivationNecessaryTags.IsEmpty() && !OwnedTags.HasAny(SlideSettings.ActivationNecessaryTags)) return false;
+	// при разборе очереди команды пачки проверяются по одному снимку, а не по тегам, выданным предыдущими командами
+	const FDASTagSet& Tags = bUseTagSnapshot ? TagSnapshot : OwnedTags.GetTagSet();
+	if (Tags.HasAny(SlideSettings.SlideTagSet)) return false;
+	if (bUseTagSnapshot && OwnedTags.HasAny(SlideSettings.SlideTagSet)) return false; // теги слайда исключительны и для команд одной пачки
+	if (Tags.HasAny(SlideSettings.BlockedTagSet)) return false;
+	if (!SlideSettings.NecessaryTagSet.IsEmpty() && !Tags.HasAny(SlideSettings.NecessaryTagSet)) return false;
 	return true;
 }
 
 bool UDynamicAbilitySystem::ChangeAbilitySlide(UDynamicAbility* Ability, const FGameplayTag& SlideName)
 {
 	if (!Ability) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to change ability slide, but ability was invalid"));
+	if (const int32 SlideId = Ability->SharedSettings->FindSlideId(SlideName); SlideId != INDEX_NONE)
+	{
+		if (bQueueAbilityCommands) return QueueAbilityCommand({ EAbilityCommandType::Slide, Ability->AbilityHandle, SlideId });
+		return ChangeAbilitySlideById(Ability, SlideId);
+	}
+	UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Settings for slide '%s' could not be found"), *SlideName.ToString());
+	return false;
+}
+
+bool UDynamicAbilitySystem::ChangeAbilitySlideById(UDynamicAbility* Ability, const int32 SlideId)
+{
+	const FGameplayTag& SlideName = Ability->SharedSettings->GetSlideTag(SlideId);
 	if (Ability->AbilityState == EAbilityState::Inactive)
 	{
 		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot change ability slide because the ability is not active"));
@@ -223,125 +599,132 @@ bool UDynamicAbilitySystem::ChangeAbilitySlide(UDynamicAbility* Ability, const F
 		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot change ability slide while the ability is activating"));
 		return false;
 	}
-	if (Ability->CurrentSlideType == SlideName)
+	if (Ability->CurrentSlideId == SlideId)
 	{
 		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot switch to slide '%s' because it is already active"), *SlideName.ToString());
 		return false;
 	}
 	
-	if (const auto NewSlideSettings = FindSlideData(Ability, ESlideSettingsType::Auto, false, SlideName))
-	{
-		if (SlideName.IsValid() && !ValidateSlideChange(*NewSlideSettings)) return false; // проверяем только если переключаемся не на базовый слайд
-		if (SlideName.IsValid() && !Ability->ValidateSlideChange(SlideName)) return false; // проверяем только если переключаемся не на базовый слайд
+	const auto& NewSlideSettings = GetSlideData(Ability, SlideId);
+	const bool bCustomSlide = SlideId != FSharedAbilitySettings::BaseSlideId;
+	if (bCustomSlide && !ValidateSlideChange(NewSlideSettings)) return false; // проверяем только если переключаемся не на базовый слайд
+	if (bCustomSlide && !Ability->ValidateSlideChange(SlideName)) return false; // проверяем только если переключаемся не на базовый слайд
 
-		if (NewSlideSettings->ActivationDelay == 0.f) OnAbilitySlideChanged(Ability, SlideName);
-		GetTickerModuleMutable<FFunHolderTickerModule>()->AddDelayedFun(Ability->AbilityName, NewSlideSettings->ActivationDelay)->Bind([this,  Ability, SlideName]
-		{
-			OnAbilitySlideChanged(Ability, SlideName);
-		});
+	const float ActivationDelay = GetSlideTimings(Ability, SlideId).ActivationDelay;
+	if (ActivationDelay == 0.f) OnAbilitySlideChanged(Ability, SlideId);
+	AddAbilityDelayedFun(Ability->AbilityHandle, ActivationDelay)->Bind([this, Handle = Ability->AbilityHandle, SlideId]
+	{
+		if (UDynamicAbility* DelayedAbility = FindAbility(Handle)) OnAbilitySlideChanged(DelayedAbility, SlideId);
+	});
 
-		Ability->AbilityState = EAbilityState::Activating;
-		if (Ability->AbilityFlags.Contains(EAbilityFlag::Updating))  // нужно если мы меняем слайд, который был в update
-		{
-			Ability->AbilityFlags.Remove(EAbilityFlag::Updating);
-			GetTickerModuleMutable<FAbilityUpdateTickerModule>()->EndUpdateAbility(Ability->AbilityName);
-		}
-		return true;
+	Ability->AbilityState = EAbilityState::Activating;
+	if (Ability->AbilityFlags.Contains(EAbilityFlag::Updating))  // нужно если мы меняем слайд, который был в update
+	{
+		Ability->AbilityFlags.Remove(EAbilityFlag::Updating);
+		EndAbilityUpdate(Ability->AbilityHandle);
 	}
-	UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Settings for slide '%s' could not be found"), *SlideName.ToString());
-	return false;
+	return true;
 }
-bool UDynamicAbilitySystem::OnAbilitySlideChanged(UDynamicAbility* Ability, const FGameplayTag& SlideName)
+bool UDynamicAbilitySystem::OnAbilitySlideChanged(UDynamicAbility* Ability, const int32 SlideId)
 {
-	if (const auto* NewSlideSettings = FindSlideData(Ability, ESlideSettingsType::Auto, false, SlideName))
-	{
-		if (!Ability->ValidateSlideChange(SlideName)) return false;
-		
-		if (!Ability->CurrentSlideType.IsValid() && SlideName.IsValid()) // переключение с базового на кастомный
-		{
-			OwnedTags.AppendTags(NewSlideSettings->SlideTags);
-		}
-		else if (Ability->CurrentSlideType.IsValid() && !SlideName.IsValid()) // переключение с кастомного на базовый
-		{
-			OwnedTags.RemoveTags(FindSlideData(Ability, ESlideSettingsType::Current, true)->SlideTags);
-		}
-		else if (Ability->CurrentSlideType.IsValid() && SlideName.IsValid()) // переключение с кастомного на кастомный
-		{
-			OwnedTags.RemoveTags(FindSlideData(Ability, ESlideSettingsType::Current, true)->SlideTags);
-			OwnedTags.AppendTags(NewSlideSettings->SlideTags);
-		}
+	const FGameplayTag& SlideName = Ability->SharedSettings->GetSlideTag(SlideId);
+	if (!Ability->ValidateSlideChange(SlideName)) return false;
 
-		if (NewSlideSettings->UpdateAbilityRate != 0.f || NewSlideSettings->bTickEveryFrame)
-		{
-			Ability->AbilityFlags.Add(EAbilityFlag::Updating);
-			const auto UpdateRate = NewSlideSettings->bTickEveryFrame ? 0.f : NewSlideSettings->UpdateAbilityRate;
-			GetTickerModuleMutable<FAbilityUpdateTickerModule>()->ReSetAbilityUpdate(Ability->AbilityName, UpdateRate, NewSlideSettings->MaxActiveTime);
-		}
-				
-		Ability->CurrentSlideType = SlideName;
-		Ability->AbilityState = EAbilityState::Active;
-		Ability->OnSlideChanged(SlideName);
-		return true;
+	const bool bFromCustom = Ability->CurrentSlideId != FSharedAbilitySettings::BaseSlideId;
+	const bool bToCustom = SlideId != FSharedAbilitySettings::BaseSlideId;
+	if (bFromCustom) // уходим с кастомного слайда, снимаем его теги
+	{
+		RevokeAbilityTags(Ability, GetCurrentSlideData(Ability).SlideTagSet);
 	}
-	UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Settings for slide '%s' could not be found"), *SlideName.ToString());
-	return false;
+	if (bToCustom) // теги базового слайда уже выданы при активации, добавляем только теги кастомного
+	{
+		GrantAbilityTags(Ability, GetSlideData(Ability, SlideId).SlideTagSet);
+	}
+	StartSlideUpdate(Ability, GetSlideTimings(Ability, SlideId));
+			
+	Ability->CurrentSlideId = SlideId;
+	Ability->AbilityState = EAbilityState::Active;
+	Ability->OnSlideChanged(SlideName);
+	return true;
 }
 
-const FAbilitySlideSettings* UDynamicAbilitySystem::FindSlideData(const UDynamicAbility* Ability, const ESlideSettingsType& SettingsType,
-	const bool bEnsureResult, const FGameplayTag& SlideName)
+bool UDynamicAbilitySystem::SetAbilitySlideOverride(const FAbilityHandle& Handle, const FGameplayTag& SlideName, const EAbilitySlideField Field, const float Value)
 {
-	if (!Ability) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to find ability slide data, but ability was invalid"));
-	const FAbilitySlideSettings* Result = nullptr;
-	switch (SettingsType)
+	UDynamicAbility* Ability = FindAbility(Handle);
+	if (!Ability)
 	{
-		case ESlideSettingsType::Auto: Result = !SlideName.IsValid() ? &Ability->AbilitySettings.BaseSlideSettings : Ability->AbilitySettings.SlidesSettings.Find(SlideName); break;
-		case ESlideSettingsType::Base: Result = &Ability->AbilitySettings.BaseSlideSettings; break;
-		case ESlideSettingsType::Custom: Result = Ability->AbilitySettings.SlidesSettings.Find(SlideName); break;
-		case ESlideSettingsType::Current: Result = !Ability->CurrentSlideType.IsValid() ? &Ability->AbilitySettings.BaseSlideSettings : Ability->AbilitySettings.SlidesSettings.Find(Ability->CurrentSlideType); break;
+		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Cannot override slide of ability with handle %d:%u because it was removed"), Handle.Index, Handle.Serial);
+		return false;
 	}
-	if (bEnsureResult && !Result)
+	const int32 SlideId = Ability->SharedSettings->FindSlideId(SlideName);
+	if (SlideId == INDEX_NONE)
 	{
-		UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Settings for slide '%s' could not be found"), *SlideName.ToString());
-		return nullptr;
+		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Settings for slide '%s' could not be found"), *SlideName.ToString());
+		return false;
 	}
-	if (!Result)
+	for (FAbilitySlideOverride& Override : Ability->SlideOverrides)
 	{
-		UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("Settings for slide '%s' could not be found"), *SlideName.ToString());
-		return nullptr;
+		if (Override.SlideId != SlideId || Override.Field != Field) continue;
+		Override.Value = Value;
+		return true;
 	}
-	return Result;
+	Ability->SlideOverrides.Add({ SlideId, Field, Value });
+	return true;
+}
+
+void UDynamicAbilitySystem::ResetAbilitySlideOverrides(const FAbilityHandle& Handle)
+{
+	if (UDynamicAbility* Ability = FindAbility(Handle)) Ability->SlideOverrides.Empty();
+}
+
+void UDynamicAbilitySystem::SubscribeAbilityInputs(const UDynamicAbility* Ability)
+{
+	for (const int32 TagIndex : Ability->SharedSettings->InputTagIndexes)
+	{
+		if (InputSubscribers.Num() <= TagIndex) InputSubscribers.SetNum(TagIndex + 1);
+		InputSubscribers[TagIndex].Add(Ability->AbilityHandle);
+	}
+}
+
+void UDynamicAbilitySystem::UnsubscribeAbilityInputs(const UDynamicAbility* Ability)
+{
+	for (const int32 TagIndex : Ability->SharedSettings->InputTagIndexes)
+	{
+		if (InputSubscribers.IsValidIndex(TagIndex)) InputSubscribers[TagIndex].RemoveSingle(Ability->AbilityHandle); // сохраняем порядок вызова обработчиков
+	}
+}
+
+TArray<FAbilityHandle, TInlineAllocator<4>> UDynamicAbilitySystem::CopyInputSubscribers(const FGameplayTag& InputKey) const
+{
+	const int32 TagIndex = FDASTagRegistry::GetTagIndex(InputKey);
+	if (!InputSubscribers.IsValidIndex(TagIndex)) return {};
+	return TArray<FAbilityHandle, TInlineAllocator<4>>(InputSubscribers[TagIndex]);
 }
 
 void UDynamicAbilitySystem::AddAbilityInput(const FGameplayTag& InputKey, const ETriggerEvent& Event)
 {
 	bool bInputCalled = false;
-	for (const auto& AbilityData : CurrentAbilities)
+	for (const FAbilityHandle& Handle : CopyInputSubscribers(InputKey))
 	{
-		if (const auto Ability = AbilityData.Value.Get(); Ability && Ability->AbilityState == EAbilityState::Active)
-		{
-			if (!Ability->AbilitySettings.InputsKeys.Contains(InputKey)) continue;
-			if (Ability->AbilityState == EAbilityState::Inactive) continue;
-			Ability->OnAddInput(InputKey, Event);
-			bInputCalled = true;
-		}
+		UDynamicAbility* Ability = FindAbility(Handle);
+		if (!Ability || Ability->AbilityState != EAbilityState::Active) continue;
+		Ability->OnAddInput(InputKey, Event);
+		bInputCalled = true;
 	}
-	if (!bInputCalled) UE_LOG(LogDynamicAbilitySystem, Error, TEXT("No ability found that can handle input with InputKey: %s"), *InputKey.ToString());
+	if (!bInputCalled) ++UnhandledInputCount;
 }
 
 void UDynamicAbilitySystem::AddAbilityInputVector(const FVector& WorldVector, const FGameplayTag& InputKey, const ETriggerEvent& Event)
 {
 	bool bInputCalled = false;
-	for (const auto& AbilityData : CurrentAbilities)
+	for (const FAbilityHandle& Handle : CopyInputSubscribers(InputKey))
 	{
-		if (const auto Ability = AbilityData.Value.Get(); Ability && Ability->AbilityState == EAbilityState::Active)
-		{
-			if (!Ability->AbilitySettings.InputsKeys.Contains(InputKey)) continue;
-			if (Ability->AbilityState == EAbilityState::Inactive) continue;
-			Ability->OnAbilityInputVector(WorldVector, InputKey, Event);
-			bInputCalled = true;
-		}
+		UDynamicAbility* Ability = FindAbility(Handle);
+		if (!Ability || Ability->AbilityState != EAbilityState::Active) continue;
+		Ability->OnAbilityInputVector(WorldVector, InputKey, Event);
+		bInputCalled = true;
 	}
-	if (!bInputCalled) UE_LOG(LogDynamicAbilitySystem, Error, TEXT("No ability found that can handle input with InputKey: %s"), *InputKey.ToString());
+	if (!bInputCalled) ++UnhandledInputCount;
 }
 
 UAttribute* UDynamicAbilitySystem::GetAttribute(const UDynamicAbility* Ability, const TSubclassOf<UAttribute>& AttributeClass)
@@ -403,24 +786,38 @@ UObject* UDynamicAbilitySystem::GetContextObject(const FName Key, const UDynamic
 void UDynamicAbilitySystem::OverrideAbilities(const UDynamicAbility* Overrider)
 {
 	if (!Overrider) UE_LOG(LogDynamicAbilitySystem, Fatal, TEXT("Attempted to override abilities, but overrider was invalid"));
-	const auto& OverriderTags = Overrider->AbilitySettings.OverrideTags;
-	for (const auto& AbilityData : CurrentAbilities)
+	const FBatchActivation Activation{ Overrider->AbilityHandle, true };
+	OverrideAbilities(MakeArrayView(&Activation, 1));
+}
+
+void UDynamicAbilitySystem::OverrideAbilities(const TConstArrayView<FBatchActivation> Activations)
+{
+	// собираем заранее: DisableAbility снимает теги и меняет корзины индекса
+	TArray<TPair<FAbilityHandle, const UDynamicAbility*>, TInlineAllocator<8>> Overridden;
+	for (int32 Position = 0; Position < Activations.Num(); ++Position)
 	{
-		const auto& Ability = AbilityData.Value.Get();
-		\
-		if (Ability == Overrider) continue;
-		if (Ability->AbilityState == EAbilityState::Inactive) continue;
-		
-		if (FindSlideData(Ability, ESlideSettingsType::Base, true)->SlideTags.HasAny(OverriderTags)) // Проверяем теги базового слайда
-		{
-			DisableAbility(Ability, EDisableType::Overridden, Overrider, FGameplayTag::EmptyTag);
-		}
-		if (Ability->CurrentSlideType.IsValid()) // Проверяем если ли кастомный активный слайд, и если да то тоже проверяем его теги тоже	
+		if (!Activations[Position].bOverrider) continue;
+		const UDynamicAbility* Overrider = FindAbility(Activations[Position].Handle);
+		if (!Overrider) continue;
+
+		// при немедленных вызовах замена прошла бы до запуска более поздних способностей пачки, поэтому их она не трогает
+		const TConstArrayView<FBatchActivation> LaterActivations = Activations.RightChop(Position + 1);
+		Overrider->SharedSettings->OverrideTagSet.ForEachExplicitIndex([&](const int32 TagIndex)
 		{
-			if (FindSlideData(Ability, ESlideSettingsType::Custom, true)->SlideTags.HasAny(OverriderTags))
+			if (!GrantedTagAbilities.IsValidIndex(TagIndex)) return;
+			for (const FAbilityHandle& Handle : GrantedTagAbilities[TagIndex])
 			{
-				DisableAbility(Ability, EDisableType::Overridden, Overrider, FGameplayTag::EmptyTag);
+				if (Handle == Overrider->AbilityHandle) continue;
+				if (LaterActivations.ContainsByPredicate([&Handle](const FBatchActivation& Later) { return Later.Handle == Handle; })) continue;
+				if (!Overridden.ContainsByPredicate([&Handle](const auto& Pair) { return Pair.Key == Handle; })) Overridden.Emplace(Handle, Overrider);
 			}
+		});
+	}
+	for (const auto& [Handle, Overrider] : Overridden)
+	{
+		if (const auto Ability = FindAbility(Handle); Ability && Ability->AbilityState != EAbilityState::Inactive)
+		{
+			DisableAbility(Ability, EDisableType::Overridden, Overrider, FGameplayTag::EmptyTag);
 		}
 	}
 }
\ No newline at end of file
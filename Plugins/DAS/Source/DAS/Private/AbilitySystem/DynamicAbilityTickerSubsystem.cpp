@@ -0,0 +1,68 @@
+﻿
+#include "AbilitySystem/DynamicAbilityTickerSubsystem.h"
+#include "AbilitySystem/DynamicAbilitySystem.h"
+#include "TickerModules/SharedAbilityTickerModules.h"
+#include "TickerModules/AbilityCommandTickerModule.h"
+#include "CoroutineTickerModule.h"
+#include "TickerWorldSubsystem.h"
+
+bool UDynamicAbilityTickerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UDynamicAbilityTickerSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Collection.InitializeDependency<UTickerWorldSubsystem>();
+	SetTickerWorld(GetWorld());
+
+	AutoActivateTickerType = { ETickerStateType::GameUnPaused };
+	AutoDisableTickerType = { ETickerStateType::GamePaused };
+	TickerDebugName = TEXT("DynamicAbilityTickerSubsystem");
+	FrameBudgetMicroseconds = FrameBudget;
+
+	FunHolderModule = AddTickerModule<FSharedFunHolderTickerModule>();
+	AbilityUpdateModule = AddTickerModule<FSharedAbilityUpdateTickerModule>();
+	CoroutineModule = AddTickerModule<FCoroutineTickerModule>();
+	CommandModule = AddTickerModule<FAbilityCommandTickerModule>();
+	AbilityUpdateModule->AbilityUpdateInvoker.Bind([](const FAbilityTickerKey& Key, const float DeltaTime)
+	{
+		return Key.System->UpdateAbility(Key.Handle, DeltaTime);
+	});
+	AbilityUpdateModule->DisableAbilityInvoker.Bind([](const FAbilityTickerKey& Key)
+	{
+		Key.System->OnAbilityUpdateExpired(Key.Handle);
+	});
+
+	if (bTickInPrePhysics)
+	{
+		SetModuleTickPhase(FunHolderModule, ETickerPhase::PrePhysics);
+		SetModuleTickPhase(AbilityUpdateModule, ETickerPhase::PrePhysics);
+		SetModuleTickPhase(CoroutineModule, ETickerPhase::PrePhysics);
+		SetModuleTickPhase(CommandModule, ETickerPhase::PrePhysics);
+	}
+}
+
+void UDynamicAbilityTickerSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+	BindTickPhases(&InWorld);
+}
+
+void UDynamicAbilityTickerSubsystem::Deinitialize()
+{
+	FunHolderModule = nullptr;
+	AbilityUpdateModule = nullptr;
+	CoroutineModule = nullptr;
+	CommandModule = nullptr;
+	UnbindTickPhases();
+	Super::Deinitialize();
+}
+
+void UDynamicAbilityTickerSubsystem::RemoveSystemTasks(const UDynamicAbilitySystem* System) const
+{
+	const auto IsSystemTask = [System](const FAbilityTickerKey& Key) { return Key.System == System; };
+	if (FunHolderModule) FunHolderModule->RemoveDelayedFunsIf(IsSystemTask);
+	if (AbilityUpdateModule) AbilityUpdateModule->RemoveUpdatesIf(IsSystemTask);
+}
@@ -0,0 +1,51 @@
+﻿
+#include "AbilitySystem/SharedAbilitySettings.h"
+#include "AbilitySystem/AbilitySettingsRegistry.h"
+
+FSharedAbilitySettings::FSharedAbilitySettings(const FDynamicAbilitySettings& Settings)
+{
+	Slides.Reserve(Settings.SlidesSettings.Num() + 1);
+	SlideTags.Reserve(Settings.SlidesSettings.Num() + 1);
+
+	Slides.Add(Settings.BaseSlideSettings);
+	SlideTags.Add(FGameplayTag::EmptyTag);
+	for (const auto& [SlideTag, SlideSettings] : Settings.SlidesSettings)
+	{
+		Slides.Add(SlideSettings);
+		SlideTags.Add(SlideTag);
+	}
+	for (FAbilitySlideSettings& Slide : Slides) Slide.CompileTagSets();
+
+	bActivateAbilityOnGranted = Settings.ActivateAbilityOnGranted;
+	InputsKeys = Settings.InputsKeys;
+	for (const FGameplayTag& InputKey : InputsKeys)
+	{
+		if (const int32 TagIndex = FDASTagRegistry::GetTagIndex(InputKey); TagIndex != INDEX_NONE) InputTagIndexes.AddUnique(TagIndex);
+	}
+	OverrideTagSet = FDASTagSet(Settings.OverrideTags);
+}
+
+TSharedRef<const FSharedAbilitySettings> FSharedAbilitySettings::FindOrCompile(const FDynamicAbilitySettings& Settings, const UObject* Source, const FName Row)
+{
+	return FAbilitySettingsRegistry::FindOrCreate<FSharedAbilitySettings>(Source, Row, [&Settings]
+	{
+		return MakeShared<const FSharedAbilitySettings>(Settings);
+	});
+}
+
+FAbilitySlideTimings FSharedAbilitySettings::GetSlideTimings(const int32 SlideId, const TConstArrayView<FAbilitySlideOverride> Overrides) const
+{
+	const FAbilitySlideSettings& Slide = Slides[SlideId];
+	FAbilitySlideTimings Timings{ Slide.ActivationDelay, Slide.UpdateAbilityRate, Slide.MaxActiveTime, Slide.bTickEveryFrame };
+	for (const FAbilitySlideOverride& Override : Overrides)
+	{
+		if (Override.SlideId != SlideId) continue;
+		switch (Override.Field)
+		{
+			case EAbilitySlideField::ActivationDelay: Timings.ActivationDelay = Override.Value; break;
+			case EAbilitySlideField::UpdateAbilityRate: Timings.UpdateAbilityRate = Override.Value; break;
+			case EAbilitySlideField::MaxActiveTime: Timings.MaxActiveTime = Override.Value; break;
+		}
+	}
+	return Timings;
+}
@@ -0,0 +1,20 @@
+﻿
+#include "TickerModules/AbilityCommandTickerModule.h"
+#include "AbilitySystem/DynamicAbilitySystem.h"
+
+void FAbilityCommandTickerModule::Tick(float DeltaTime)
+{
+	Swap(PendingSystems, ResolvingSystems);
+	for (const TWeakObjectPtr<UDynamicAbilitySystem>& WeakSystem : ResolvingSystems)
+	{
+		if (UDynamicAbilitySystem* System = WeakSystem.Get()) System->ResolveAbilityCommands();
+	}
+	ResolvingSystems.Reset();
+}
+
+void FAbilityCommandTickerModule::AddPendingSystem(UDynamicAbilitySystem* System)
+{
+	check(System)
+	PendingSystems.AddUnique(System);
+	TryStartTicker();
+}
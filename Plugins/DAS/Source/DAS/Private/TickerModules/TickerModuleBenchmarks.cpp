@@ -0,0 +1,184 @@
+﻿
+#include "TickerBenchmark.h"
+#include "AbilitySystem/DynamicAbilitySystem.h"
+#include "HAL/IConsoleManager.h"
+#include "TickerModules/AbilityUpdateTickerModule.h"
+#include "TickerModules/FunHolderTickerModule.h"
+
+/**
+ * Замеры модулей тикера DAS, запускаются консольными командами в сборках с WITH_TICKER_INSTRUMENTATION.
+ * Модули работают в отдельном менеджере на подменённом времени, поэтому замер не зависит от частоты кадров.
+ */
+#if WITH_TICKER_INSTRUMENTATION
+
+namespace DASTickerBenchmarks
+{
+	/** Шаг времени замеров, один тик - один кадр на 60 FPS */
+	static constexpr double FrameTime = 1.0 / 60.0;
+
+	/** Хендл способности замера, в модулях системы задачи адресуются хендлами */
+	FORCEINLINE FAbilityHandle MakeBenchmarkHandle(const int32 Index)
+	{
+		return FAbilityHandle{ Index, 0 };
+	}
+
+	/**
+	 * Проверка короткой задачи, добавленной пока модуль спит до дедлайна длинной:
+	 * задержка короткой задачи должна отсчитываться от момента добавления, а не от последнего тика модуля.
+	 */
+	void CheckShortDelayAfterLong()
+	{
+		static constexpr double LongDelay = 10.0;
+		static constexpr double SleepTime = 5.0;
+		static constexpr double ShortDelay = 0.5;
+
+		FTickerBenchmarkManager Manager;
+		FFunHolderTickerModule* Module = Manager.AddTickerModule<FFunHolderTickerModule>();
+		Module->AddDelayedFun(MakeBenchmarkHandle(0), LongDelay)->Bind([] {});
+		Manager.TickImmediately();
+
+		// модуль спит до дедлайна длинной задачи, тики менеджера его не обновляют
+		for (double Time = 0.0; Time < SleepTime; Time += FrameTime)
+		{
+			Manager.AdvanceTime(FrameTime);
+			Manager.TickImmediately();
+		}
+
+		bool bExecuted = false;
+		Module->AddDelayedFun(MakeBenchmarkHandle(1), ShortDelay)->Bind([&bExecuted] { bExecuted = true; });
+		double Elapsed = 0.0;
+		while (!bExecuted && Elapsed < LongDelay)
+		{
+			Elapsed += FrameTime;
+			Manager.AdvanceTime(FrameTime);
+			Manager.TickImmediately();
+		}
+
+		if (FMath::Abs(Elapsed - ShortDelay) > FrameTime * 2.0)
+		{
+			UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("FunHolder short delay after long one: expected %.3f s, executed after %.3f s"), ShortDelay, Elapsed);
+		}
+		else UE_LOG(LogDynamicAbilitySystem, Display, TEXT("FunHolder short delay after long one: executed after %.3f s"), Elapsed);
+	}
+
+	/**
+	 * DAS.Benchmark.FunHolder [TaskCounts...]
+	 * Добавление, тик до вызова всех задач и отмена отложенных функций. Дедлайны задач равномерно распределены на SpreadSeconds.
+	 * Перед замерами проверяет задержку задачи, добавленной во время сна модуля.
+	 */
+	void BenchmarkFunHolder(const TArray<FString>& Args)
+	{
+		static constexpr double SpreadSeconds = 5.0;
+		const TArray<int32> TaskCounts = TickerBenchmarks::ParseSizes(Args, 0, { 1000, 10000, 100000 });
+		CheckShortDelayAfterLong();
+
+		FTickerBenchmarkReport Report(TEXT("FunHolder"));
+		for (const int32 TaskCount : TaskCounts)
+		{
+			FTickerBenchmarkManager Manager;
+			FFunHolderTickerModule* Module = Manager.AddTickerModule<FFunHolderTickerModule>();
+			int32 ExecutedCount = 0;
+
+			Report.BeginSample();
+			for (int32 Index = 0; Index < TaskCount; ++Index)
+			{
+				const float Delay = static_cast<float>(SpreadSeconds * Index / TaskCount);
+				Module->AddDelayedFun(MakeBenchmarkHandle(Index), Delay)->Bind([&ExecutedCount] { ++ExecutedCount; });
+			}
+			Report.AddSample(TEXT("Add"), TaskCount, TaskCount);
+
+			// лишние тики на случай, если часть задач не вызовется, замер не должен зависнуть
+			const int32 MaxTicks = FMath::CeilToInt32(SpreadSeconds / FrameTime) + 60;
+			int32 TickCount = 0;
+			Report.BeginSample();
+			for (; ExecutedCount < TaskCount && TickCount < MaxTicks; ++TickCount)
+			{
+				Manager.AdvanceTime(FrameTime);
+				Manager.TickImmediately();
+			}
+			Report.AddSample(TEXT("Tick"), TaskCount, TickCount);
+			if (ExecutedCount != TaskCount)
+			{
+				UE_LOG(LogDynamicAbilitySystem, Warning, TEXT("FunHolder benchmark executed %d of %d tasks"), ExecutedCount, TaskCount);
+				// невызванные задачи заняли бы ключи, и добавление ниже вернуло бы nullptr
+				for (int32 Index = 0; Index < TaskCount; ++Index) Module->RemoveDelayedFun(MakeBenchmarkHandle(Index));
+			}
+
+			for (int32 Index = 0; Index < TaskCount; ++Index)
+			{
+				Module->AddDelayedFun(MakeBenchmarkHandle(Index), SpreadSeconds)->Bind([] {});
+			}
+			Report.BeginSample();
+			for (int32 Index = 0; Index < TaskCount; ++Index) Module->RemoveDelayedFun(MakeBenchmarkHandle(Index));
+			Report.AddSample(TEXT("Remove"), TaskCount, TaskCount);
+		}
+		Report.Save();
+	}
+
+	/**
+	 * DAS.Benchmark.AbilityUpdate [Ticks] [TaskCounts...]
+	 * Тик модуля обновления способностей с постоянным набором задач и с перезапуском 1% задач каждый кадр.
+	 */
+	void BenchmarkAbilityUpdate(const TArray<FString>& Args)
+	{
+		const int32 Ticks = Args.IsValidIndex(0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 600;
+		const TArray<int32> TaskCounts = TickerBenchmarks::ParseSizes(Args, 1, { 1000, 2500, 5000, 10000 });
+
+		// часть задач обновляется каждый кадр, остальные с периодом до 0.1 секунды
+		const auto GetUpdateRate = [](const int32 Index) { return static_cast<float>(Index % 8) * 0.0125f; };
+
+		FTickerBenchmarkReport Report(TEXT("AbilityUpdate"));
+		for (const int32 TaskCount : TaskCounts)
+		{
+			FTickerBenchmarkManager Manager;
+			FAbilityUpdateTickerModule* Module = Manager.AddTickerModule<FAbilityUpdateTickerModule>();
+			int64 UpdateCount = 0;
+			Module->AbilityUpdateInvoker.Bind([&UpdateCount](const FAbilityHandle&, float) { ++UpdateCount; return true; });
+			Module->DisableAbilityInvoker.Bind([](const FAbilityHandle&) {});
+
+			Report.BeginSample();
+			for (int32 Index = 0; Index < TaskCount; ++Index)
+			{
+				Module->StartAbilityUpdate(MakeBenchmarkHandle(Index), GetUpdateRate(Index), 0.f);
+			}
+			Report.AddSample(TEXT("Add"), TaskCount, TaskCount);
+			Manager.TickImmediately(); // первый тик собирает волны менеджера, в замер не входит
+
+			Report.BeginSample();
+			for (int32 TickIndex = 0; TickIndex < Ticks; ++TickIndex)
+			{
+				Manager.AdvanceTime(FrameTime);
+				Manager.TickImmediately();
+			}
+			Report.AddSample(TEXT("Tick"), TaskCount, Ticks);
+
+			const int32 ChurnCount = FMath::Max(TaskCount / 100, 1);
+			Report.BeginSample();
+			for (int32 TickIndex = 0; TickIndex < Ticks; ++TickIndex)
+			{
+				for (int32 Churn = 0; Churn < ChurnCount; ++Churn)
+				{
+					const int32 Index = (TickIndex * ChurnCount + Churn) % TaskCount;
+					Module->ReSetAbilityUpdate(MakeBenchmarkHandle(Index), GetUpdateRate(Index), 0.f);
+				}
+				Manager.AdvanceTime(FrameTime);
+				Manager.TickImmediately();
+			}
+			Report.AddSample(TEXT("TickWithChurn"), TaskCount, Ticks);
+			UE_LOG(LogDynamicAbilitySystem, Display, TEXT("AbilityUpdate benchmark [%d]: %lld ability updates"), TaskCount, UpdateCount);
+		}
+		Report.Save();
+	}
+
+	static FAutoConsoleCommand FunHolderBenchmarkCommand(
+		TEXT("DAS.Benchmark.FunHolder"),
+		TEXT("Benchmarks FFunHolderTickerModule add, tick and remove, writes CSV. Args: [TaskCounts...]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkFunHolder));
+
+	static FAutoConsoleCommand AbilityUpdateBenchmarkCommand(
+		TEXT("DAS.Benchmark.AbilityUpdate"),
+		TEXT("Benchmarks FAbilityUpdateTickerModule tick against task count, writes CSV. Args: [Ticks] [TaskCounts...]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkAbilityUpdate));
+}
+
+#endif
@@ -0,0 +1,24 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Хендл способности в UDynamicAbilitySystem: индекс ячейки в таблице способностей системы и поколение ячейки.
+ * Разрешается в способность одним чтением из массива, хендл удалённой способности ни во что не разрешается,
+ * даже если её ячейку уже заняла другая способность.
+ */
+struct FAbilityHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+	FORCEINLINE bool operator==(const FAbilityHandle& Other) const { return Index == Other.Index && Serial == Other.Serial; }
+	FORCEINLINE bool operator!=(const FAbilityHandle& Other) const { return !(*this == Other); }
+
+	FORCEINLINE friend uint32 GetTypeHash(const FAbilityHandle& Handle)
+	{
+		return HashCombineFast(static_cast<uint32>(Handle.Index), Handle.Serial);
+	}
+};
@@ -0,0 +1,36 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * Реестр неизменяемых настроек способностей, общих для всех экземпляров.
+ * Настройки одного источника (класс способности или таблица данных) и строки собираются один раз,
+ * экземпляры держат их через TSharedRef и удаляются вместе с последним владельцем. Записи удалённых настроек
+ * вычищаются при каждой сборке новых, поэтому ключи пересобранных классов не копятся, а после перезапуска PIE настройки собираются заново. Отдельный кэш на каждый тип настроек, только на игровом потоке.
+ */
+struct FAbilitySettingsRegistry
+{
+	template<typename SettingsT, typename FactoryT>
+	static TSharedRef<const SettingsT> FindOrCreate(const UObject* Source, const FName Row, FactoryT&& Factory)
+	{
+		check(IsInGameThread())
+		static TMap<TPair<FObjectKey, FName>, TWeakPtr<const SettingsT>> Cache;
+
+		const TPair<FObjectKey, FName> Key(FObjectKey(Source), Row);
+		if (const TWeakPtr<const SettingsT>* CachedSettings = Cache.Find(Key))
+		{
+			if (const TSharedPtr<const SettingsT> Settings = CachedSettings->Pin()) return Settings.ToSharedRef();
+		}
+
+		// промах бывает один раз на источник, здесь же убираем записи настроек, у которых не осталось владельцев
+		for (auto It = Cache.CreateIterator(); It; ++It)
+		{
+			if (!It->Value.IsValid()) It.RemoveCurrent();
+		}
+		TSharedRef<const SettingsT> Settings = Factory();
+		Cache.Add(Key, Settings);
+		return Settings;
+	}
+};
@@ -0,0 +1,19 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "TickerTask.h"
+
+class UDynamicAbilitySystem;
+
+/** Ожидание тега системы: если тега ещё нет, корутина не тикает, а возобновляется системой в момент добавления тега */
+struct DAS_API FAbilityTagAddedAwaiter
+{
+	UDynamicAbilitySystem* System;
+	FGameplayTag Tag;
+
+	bool await_ready() const;
+	void await_suspend(FTickerTask::FHandle Coroutine) const;
+	void await_resume() const noexcept {}
+};
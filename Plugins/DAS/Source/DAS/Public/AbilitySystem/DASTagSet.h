@@ -0,0 +1,216 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+/**
+ * Реестр плотных номеров тегов для FDASTagSet. При первом обращении нумерует все теги проекта,
+ * теги, зарегистрированные позже, получают номер при первом использовании. Для каждого тега хранятся номера его родителей,
+ * поэтому набор раскрывает родителей без обращения к UGameplayTagsManager. Работает только на игровом потоке.
+ */
+struct DAS_API FDASTagRegistry
+{
+	/** Номер тега, при первом обращении к тегу выдаёт новый. INDEX_NONE для невалидного тега */
+	static int32 GetTagIndex(const FGameplayTag& Tag);
+
+	/** Номера тега и всех его родителей */
+	static TConstArrayView<int32> GetTagLineage(const int32 TagIndex);
+
+	static FGameplayTag GetTag(const int32 TagIndex);
+};
+
+/**
+ * Набор тегов в виде битовых слов по номерам FDASTagRegistry, замена FGameplayTagContainer для частых проверок.
+ * Хранит явные теги и те же теги вместе с родителями, поэтому HasAny и HasAll - это AND по словам без поиска и хешей,
+ * такие циклы компилятор векторизует. Семантика проверок совпадает с FGameplayTagContainer:
+ * набор содержит тег, если содержит его или любого его потомка.
+ */
+class DAS_API FDASTagSet
+{
+	friend class FDASTagCountSet;
+
+	using FWords = TArray<uint64, TInlineAllocator<4>>;
+
+	/** Явно добавленные теги */
+	FWords ExplicitWords;
+
+	/** Явные теги и их родители, по ним отвечают проверки */
+	FWords MatchWords;
+
+	static FORCEINLINE void SetBit(FWords& Words, const int32 Index)
+	{
+		const int32 WordIndex = Index >> 6;
+		if (Words.Num() <= WordIndex) Words.SetNumZeroed(WordIndex + 1);
+		Words[WordIndex] |= 1ull << (Index & 63);
+	}
+	static FORCEINLINE bool TestBit(const FWords& Words, const int32 Index)
+	{
+		const int32 WordIndex = Index >> 6;
+		return Index != INDEX_NONE && WordIndex < Words.Num() && (Words[WordIndex] >> (Index & 63)) & 1;
+	}
+	static FORCEINLINE void ClearBit(FWords& Words, const int32 Index)
+	{
+		Words[Index >> 6] &= ~(1ull << (Index & 63));
+	}
+
+	void AddTagIndex(const int32 TagIndex);
+
+	/** Пересобирает MatchWords по явным тегам, нужно после удаления, так как родитель может остаться от другого тега */
+	void RebuildMatchWords();
+public:
+	FDASTagSet() = default;
+	explicit FDASTagSet(const FGameplayTagContainer& Container) { AppendTags(Container); }
+
+	void AddTag(const FGameplayTag& Tag);
+	void RemoveTag(const FGameplayTag& Tag);
+
+	void AppendTags(const FGameplayTagContainer& Container);
+	void AppendTags(const FDASTagSet& Other);
+	void RemoveTags(const FDASTagSet& Other);
+
+	/** Есть ли тег или его потомок */
+	FORCEINLINE bool HasTag(const FGameplayTag& Tag) const
+	{
+		return TestBit(MatchWords, FDASTagRegistry::GetTagIndex(Tag));
+	}
+
+	/** Есть ли тег, добавленный явно */
+	FORCEINLINE bool HasTagExact(const FGameplayTag& Tag) const
+	{
+		return TestBit(ExplicitWords, FDASTagRegistry::GetTagIndex(Tag));
+	}
+
+	/** Есть ли хотя бы один тег Other (или его потомок) */
+	FORCEINLINE bool HasAny(const FDASTagSet& Other) const
+	{
+		const int32 WordCount = FMath::Min(MatchWords.Num(), Other.ExplicitWords.Num());
+		const uint64* RESTRICT Match = MatchWords.GetData();
+		const uint64* RESTRICT Query = Other.ExplicitWords.GetData();
+		uint64 Result = 0;
+		for (int32 Index = 0; Index < WordCount; ++Index) Result |= Match[Index] & Query[Index];
+		return Result != 0;
+	}
+
+	/** Есть ли все теги Other (или их потомки), для пустого Other всегда true */
+	FORCEINLINE bool HasAll(const FDASTagSet& Other) const
+	{
+		const int32 WordCount = Other.ExplicitWords.Num();
+		const uint64* RESTRICT Match = MatchWords.GetData();
+		const uint64* RESTRICT Query = Other.ExplicitWords.GetData();
+		uint64 Missing = 0;
+		for (int32 Index = 0; Index < WordCount; ++Index) Missing |= Query[Index] & ~(Index < MatchWords.Num() ? Match[Index] : 0);
+		return Missing == 0;
+	}
+
+	/** Вызывает Function(TagIndex) для каждого явного тега набора */
+	template<typename FunctionT>
+	FORCEINLINE void ForEachExplicitIndex(FunctionT Function) const
+	{
+		for (int32 WordIndex = 0; WordIndex < ExplicitWords.Num(); ++WordIndex)
+		{
+			for (uint64 Word = ExplicitWords[WordIndex]; Word; Word &= Word - 1) Function(WordIndex * 64 + FMath::CountTrailingZeros64(Word));
+		}
+	}
+
+	bool IsEmpty() const;
+	FORCEINLINE void Reset()
+	{
+		ExplicitWords.Reset();
+		MatchWords.Reset();
+	}
+
+	/** Явные теги набора, для Blueprint и окна отладки */
+	FGameplayTagContainer ToContainer() const;
+};
+
+/**
+ * Набор тегов со счётчиками владения: один и тот же тег могут выдать несколько источников,
+ * и тег пропадает только когда его убрал последний из них. Добавление и удаление стоят O(1) на тег (и его родителей),
+ * а колбэк изменения вызывается только когда HasTag тега меняется, то есть когда счётчик тега или его потомков проходит через ноль.
+ */
+class DAS_API FDASTagCountSet
+{
+	/** Теги, у которых счётчик больше нуля */
+	FDASTagSet Tags;
+
+	/** Сколько раз тег добавлен явно, по номеру тега */
+	TArray<int32> ExplicitCounts;
+
+	/** Сколько явных тегов-источников держат тег, сам тег или его потомки, по номеру тега */
+	TArray<int32> MatchCounts;
+
+	static FORCEINLINE int32& GetCount(TArray<int32>& Counts, const int32 TagIndex)
+	{
+		if (Counts.Num() <= TagIndex) Counts.SetNumZeroed(TagIndex + 1);
+		return Counts[TagIndex];
+	}
+
+	/** Номера тегов, счётчик которых прошёл через ноль */
+	using FChangedIndexes = TArray<int32, TInlineAllocator<8>>;
+public:
+	/**
+	 * Добавляет по одной ссылке на каждый тег Added, OnChanged(Tag, true) вызывается для тегов, появившихся в наборе.
+	 * Колбэки вызываются после обновления всех счётчиков: подписчик видит набор целиком и может регистрировать новые теги
+	 */
+	template<typename CallbackT>
+	void AddTags(const FDASTagSet& Added, CallbackT OnChanged)
+	{
+		FChangedIndexes Changed;
+		Added.ForEachExplicitIndex([&](const int32 TagIndex)
+		{
+			if (++GetCount(ExplicitCounts, TagIndex) == 1) FDASTagSet::SetBit(Tags.ExplicitWords, TagIndex);
+			for (const int32 Index : FDASTagRegistry::GetTagLineage(TagIndex))
+			{
+				if (++GetCount(MatchCounts, Index) != 1) continue;
+				FDASTagSet::SetBit(Tags.MatchWords, Index);
+				Changed.Add(Index);
+			}
+		});
+		for (const int32 Index : Changed) OnChanged(FDASTagRegistry::GetTag(Index), true);
+	}
+
+	/** Убирает по одной ссылке на каждый тег Removed, теги без ссылок пропускаются. OnChanged(Tag, false) - для пропавших тегов, после обновления счётчиков */
+	template<typename CallbackT>
+	void RemoveTags(const FDASTagSet& Removed, CallbackT OnChanged)
+	{
+		FChangedIndexes Changed;
+		Removed.ForEachExplicitIndex([&](const int32 TagIndex)
+		{
+			if (!ExplicitCounts.IsValidIndex(TagIndex) || ExplicitCounts[TagIndex] == 0) return;
+			if (--ExplicitCounts[TagIndex] == 0) FDASTagSet::ClearBit(Tags.ExplicitWords, TagIndex);
+			for (const int32 Index : FDASTagRegistry::GetTagLineage(TagIndex))
+			{
+				if (--MatchCounts[Index] != 0) continue;
+				FDASTagSet::ClearBit(Tags.MatchWords, Index);
+				Changed.Add(Index);
+			}
+		});
+		for (const int32 Index : Changed) OnChanged(FDASTagRegistry::GetTag(Index), false);
+	}
+
+	FORCEINLINE void AddTags(const FDASTagSet& Added) { AddTags(Added, [](const FGameplayTag&, bool) {}); }
+	FORCEINLINE void RemoveTags(const FDASTagSet& Removed) { RemoveTags(Removed, [](const FGameplayTag&, bool) {}); }
+
+	/** Сколько раз тег добавлен явно */
+	FORCEINLINE int32 GetTagCount(const FGameplayTag& Tag) const
+	{
+		const int32 TagIndex = FDASTagRegistry::GetTagIndex(Tag);
+		return ExplicitCounts.IsValidIndex(TagIndex) ? ExplicitCounts[TagIndex] : 0;
+	}
+
+	FORCEINLINE bool HasTag(const FGameplayTag& Tag) const { return Tags.HasTag(Tag); }
+	FORCEINLINE bool HasAny(const FDASTagSet& Other) const { return Tags.HasAny(Other); }
+	FORCEINLINE bool HasAll(const FDASTagSet& Other) const { return Tags.HasAll(Other); }
+	FORCEINLINE bool IsEmpty() const { return Tags.IsEmpty(); }
+
+	/** Текущие теги без счётчиков */
+	FORCEINLINE const FDASTagSet& GetTagSet() const { return Tags; }
+
+	FORCEINLINE void Reset()
+	{
+		Tags.Reset();
+		ExplicitCounts.Reset();
+		MatchCounts.Reset();
+	}
+};
@@ -4,6 +4,9 @@
 #include "CoreMinimal.h"
 #include "EnhancedInputComponent.h"
 #include "GameplayTagContainer.h"
+#include "AbilityTickerTasks.h"
+#include "AbilityHandle.h"
+#include "DASTagSet.h"
 
 #if WITH_TOUCH
 	#include "ManagerImpl/TouchManager.h"
@@ -15,6 +18,7 @@
 #include "DynamicAbility.generated.h"
 
 class UAttribute;
+class FSharedAbilitySettings;
 
 UENUM(BlueprintType)
 enum class EAbilityState : uint8
@@ -27,9 +31,27 @@ enum class EAbilityState : uint8
 enum class EAbilityFlag : uint8
 {
 	Updating = 0,
+	TagsGranted = 1, // теги базового слайда выданы системе, до окончания задержки активации их нет
+	TagsIndexed = 2, // теги базового слайда записаны в индекс замены уже с начала задержки активации, чтобы замена могла отменить замах
 };
 ENUM_CLASS_FLAGS(EAbilityFlag)
 
+/** Поле слайда, которое можно переопределить у отдельной способности */
+enum class EAbilitySlideField : uint8
+{
+	ActivationDelay,
+	UpdateAbilityRate,
+	MaxActiveTime,
+};
+
+/** Переопределение одного поля слайда у экземпляра способности поверх общих настроек FSharedAbilitySettings */
+struct FAbilitySlideOverride
+{
+	int32 SlideId = 0;
+	EAbilitySlideField Field = EAbilitySlideField::ActivationDelay;
+	float Value = 0.f;
+};
+
 
 enum class EDisableType
 {
@@ -97,6 +119,18 @@ struct FAbilitySlideSettings
 	*/
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SlideSettings")
 	FGameplayTagContainer ActivationBlockedTags;
+
+	/** Теги слайда в виде FDASTagSet для проверок системы, собираются из контейнеров выше через CompileTagSets */
+	FDASTagSet SlideTagSet;
+	FDASTagSet NecessaryTagSet;
+	FDASTagSet BlockedTagSet;
+
+	FORCEINLINE void CompileTagSets()
+	{
+		SlideTagSet = FDASTagSet(SlideTags);
+		NecessaryTagSet = FDASTagSet(ActivationNecessaryTags);
+		BlockedTagSet = FDASTagSet(ActivationBlockedTags);
+	}
 };
 
 USTRUCT(BlueprintType)
@@ -127,7 +161,10 @@ struct FDynamicAbilitySettings : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BaseSettings")
 	FGameplayTagContainer OverrideTags;
 
-	/** Все слайды и их настройки которые способность может переключать во время ее работы */
+	/**
+	 * Все слайды и их настройки которые способность может переключать во время ее работы.
+	 * Система работает с ними через FSharedAbilitySettings, собранные из этих настроек.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "BaseSettings")
 	TMap<FGameplayTag, FAbilitySlideSettings> SlidesSettings;
 };
@@ -140,6 +177,7 @@ class DAS_API UDynamicAbility : public UObject
 	template<typename T, typename AbilityT>
 	friend class FAbilityInfoWindowModule;
 	friend class UDynamicAbilitySystem;
+	friend class UDynamicAbilityPoolSubsystem;
 
 	/** Не посредственно владелец способности и всей системы в которой она работает */
 	UPROPERTY()
@@ -149,21 +187,47 @@ class DAS_API UDynamicAbility : public UObject
 	UPROPERTY()
 	TObjectPtr<UDynamicAbilitySystem> AbilitySystem;
 
-	/** Тег, обозначающий активный (текущий) слайд способности */
-	FGameplayTag CurrentSlideType;
+	/** Номер активного (текущего) слайда способности в SharedSettings */
+	int32 CurrentSlideId = 0;
+
+	/** Собранные настройки способности, общие для всех экземпляров с тем же источником настроек */
+	TSharedPtr<const FSharedAbilitySettings> SharedSettings;
+
+	/** Отличия этого экземпляра от SharedSettings, у большинства способностей пусто */
+	TArray<FAbilitySlideOverride> SlideOverrides;
 
 	/** Все активные флаги этой способности (битовая маска EAbilityFlag) */
 	TSet<EAbilityFlag> AbilityFlags;
 
 	/** Текущее состояние этой способности */
 	EAbilityState AbilityState = EAbilityState::Inactive;
+
+	/** Корутины способности, запущенные через RunTask, отменяются при выключении способности */
+	TArray<FTickerTaskHandle> RunningTasks;
+
+	/** Хендл способности в системе, по нему её адресуют модули тикера системы */
+	FAbilityHandle AbilityHandle;
+
+	/** Возвращает состояние, которое задаёт система, к состоянию нового объекта и вызывает ResetAbility */
+	void ResetPooledState();
 protected:
 	FORCEINLINE const AActor* GetOwner() const { return Owner.Get(); }
-	FORCEINLINE const FGameplayTag& GetCurrentSlideTag() const { return CurrentSlideType; }
+	const FGameplayTag& GetCurrentSlideTag() const;
 	FORCEINLINE const EAbilityState& GetAbilityState() const { return AbilityState; }
 	FORCEINLINE TSet<EAbilityFlag> GetAbilityFlags() const { return AbilityFlags; }
 	FORCEINLINE const UDynamicAbilitySystem* GetAbilitySystem() const { return AbilitySystem.Get(); }
 
+	/**
+	 * Запускает корутину на тикере системы, вместо цепочек отложенных функций:
+	 *	co_await TickerTask::Seconds(0.2f);
+	 *	co_await UntilTagAdded(Tag);
+	 * Корутина отменяется при выключении способности.
+	 */
+	FTickerTaskHandle RunTask(FTickerTask&& Task);
+
+	/** Ожидание добавления тега в систему для co_await внутри корутины способности */
+	FORCEINLINE FAbilityTagAddedAwaiter UntilTagAdded(const FGameplayTag& Tag) const { return { AbilitySystem.Get(), Tag }; }
+
 #if WITH_TOUCH
 	const UTouchManager* GetTouchSystem() const;
 
@@ -194,8 +258,12 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings")
 	bool bMustSearchSettings = false;
 
-	/** Не посредственно сами настройки способности */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings")
+	/**
+	 * Настройки способности по умолчанию, задаются в классе или конструкторе наследника.
+	 * Система собирает из них SharedSettings один раз на класс, а при bMustSearchSettings не читает их вовсе,
+	 * поэтому изменение во время игры ни на что не влияет и поле только для чтения
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Settings")
 	FDynamicAbilitySettings AbilitySettings;
 
 	/** Функция для получения не const указателя на менеджер */ 
@@ -231,6 +299,12 @@ protected:
 	/** Вызывается при удалении у игрока способности */
 	virtual void OnAbilityRemoved(const UObject* Remover) {}
 
+	/**
+	 * Вызывается при возврате способности в пул UDynamicAbilityPoolSubsystem, после OnAbilityRemoved.
+	 * Наследник возвращает здесь свои поля к значениям по умолчанию, так как экземпляр будет выдан другой системе.
+	 */
+	virtual void ResetAbility() {}
+
 	/** Вызывается при активации способности */
 	virtual void OnAbilityActivated(const UObject* Activator) {}
 
@@ -247,4 +321,5 @@ protected:
 	virtual void OnAbilityInputVector(const FVector& WorldVector, const FGameplayTag& InputKey, const ETriggerEvent& Event) {}
 public:
 	FORCEINLINE const FName& GetAbilityName() const { return AbilityName; }
+	FORCEINLINE FAbilityHandle GetAbilityHandle() const { return AbilityHandle; }
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DynamicAbilityPoolSubsystem.generated.h"
+
+class UDynamicAbility;
+
+/** Настройки пула одного класса способности в конфиге */
+USTRUCT()
+struct FDynamicAbilityPoolClassSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSoftClassPtr<UDynamicAbility> AbilityClass;
+
+	/** Сколько экземпляров создать при старте мира */
+	UPROPERTY()
+	int32 PrewarmCount = 0;
+
+	/** Сколько свободных экземпляров хранит пул, INDEX_NONE - DefaultMaxPoolSize */
+	UPROPERTY()
+	int32 MaxPoolSize = INDEX_NONE;
+};
+
+/** Статистика пула одного класса способности */
+struct FDynamicAbilityPoolStats
+{
+	/** Выдано из пула */
+	int32 Hits = 0;
+
+	/** Пул был пуст, экземпляр создан через NewObject */
+	int32 Misses = 0;
+
+	/** Возвращено в пул */
+	int32 Returns = 0;
+
+	/** Пул был полон, возвращённый экземпляр отдан GC */
+	int32 Discards = 0;
+
+	FORCEINLINE float GetHitRate() const
+	{
+		const int32 Borrows = Hits + Misses;
+		return Borrows ? static_cast<float>(Hits) / Borrows : 0.f;
+	}
+};
+
+USTRUCT()
+struct FDynamicAbilityPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<UDynamicAbility>> FreeAbilities;
+
+	int32 MaxSize = 0;
+	FDynamicAbilityPoolStats Stats;
+};
+
+/**
+ * Пул экземпляров способностей мира по классу.
+ * Системы с включённым bUseAbilityPool берут способности из пула вместо NewObject и возвращают их при удалении,
+ * поэтому частая выдача и снятие способностей (бонусы, смена снаряжения) не создаёт новых UObject и не нагружает GC.
+ * Экземпляры пула принадлежат подсистеме, при возврате система сбрасывает их через UDynamicAbility::ResetAbility.
+ * Размеры пулов и прогрев задаются в конфиге, статистику выводит команда DAS.AbilityPool.Stats.
+ */
+UCLASS(Config = Game)
+class DAS_API UDynamicAbilityPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Сколько свободных экземпляров хранит пул класса, которого нет в ClassSettings */
+	UPROPERTY(Config)
+	int32 DefaultMaxPoolSize = 8;
+
+	UPROPERTY(Config)
+	TArray<FDynamicAbilityPoolClassSettings> ClassSettings;
+
+	UPROPERTY()
+	TMap<TSubclassOf<UDynamicAbility>, FDynamicAbilityPool> Pools;
+
+	FDynamicAbilityPool& FindOrAddPool(const TSubclassOf<UDynamicAbility>& AbilityClass);
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	/** Свободный экземпляр класса из пула или новый, если пул пуст */
+	UDynamicAbility* BorrowAbility(const TSubclassOf<UDynamicAbility>& AbilityClass);
+
+	/** Сбрасывает способность и кладёт её в пул, если в нём есть место */
+	void ReturnAbility(UDynamicAbility* Ability);
+
+	/** Дополняет пул класса до Count свободных экземпляров, но не больше его размера */
+	void PrewarmPool(const TSubclassOf<UDynamicAbility>& AbilityClass, const int32 Count);
+
+	/** Статистика пула класса или nullptr, если класс ещё не брали */
+	const FDynamicAbilityPoolStats* GetPoolStats(const TSubclassOf<UDynamicAbility>& AbilityClass) const;
+
+	void LogPoolStats() const;
+};
@@ -4,6 +4,7 @@
 #include "CoreMinimal.h"
 #include "Attribute.h"
 #include "DynamicAbility.h"
+#include "SharedAbilitySettings.h"
 #include "StaticTickerManager.h"
 
 #if WITH_TOUCH
@@ -15,18 +16,16 @@
 
 #include "DynamicAbilitySystem.generated.h"
 
+struct FUpdateAbilityTickerData;
+class UDynamicAbilityTickerSubsystem;
+class UDynamicAbilityPoolSubsystem;
+class FCoroutineTickerModule;
+class FAbilityCommandTickerModule;
+
 DECLARE_LOG_CATEGORY_EXTERN(LogDynamicAbilitySystem, Log, All);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAddedAbility, FName, Key);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnRemovedAbility, FName, Key);
 
-enum class ESlideSettingsType
-{
-	Auto,
-	Base,
-	Custom,
-	Current
-};
-
 USTRUCT(BlueprintType)
 struct FContextObjectSettings
 {
@@ -52,12 +51,57 @@ class DAS_API UDynamicAbilitySystem : public UActorComponent, public FStaticTick
 
 	template<typename T, typename AbilityT>
 	friend class FAbilityInfoWindowModule;
+	friend class UDynamicAbilityTickerSubsystem;
+	friend class FAbilityCommandTickerModule;
+	friend struct FAbilityTagAddedAwaiter;
 
 protected:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability")
 	TObjectPtr<UDataTable> AbilitiesSettings;
 
+	/** Брать способности из пула мира UDynamicAbilityPoolSubsystem и возвращать их туда при удалении вместо создания новых объектов */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability")
+	bool bUseAbilityPool = false;
+
+	/**
+	 * Копить ActivateAbility, ForcedAbilityDisable и ChangeAbilitySlide за кадр и разбирать их одним проходом в тикере системы.
+	 * Сначала выполняются выключения, затем смены слайдов и активации в порядке вызова. Необходимые и блокирующие теги проверяются по одному снимку тегов системы,
+	 * а замена способностей выполняется один раз на всю пачку. Вызовы в этом режиме только ставят команду и возвращают true.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ability")
+	bool bQueueAbilityCommands = false;
+
+	/**
+	 * Если включено, система не создаёт свои модули и тикер, а отдаёт задержки и обновления способностей в общий тикер мира.
+	 * Нужно для большого количества систем (например у AI), чтобы все они обновлялись одним тикером.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ticker")
+	bool bUseSharedTicker = false;
+
+	/** Обновлять способности с фиксированной частотой, чтобы UpdateRate и MaxActiveTime не зависели от FPS */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ticker", meta = (EditCondition = "!bUseSharedTicker"))
+	bool bFixedTickerStep = false;
+
+	/** Частота шагов тикера в герцах */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ticker", meta = (EditCondition = "bFixedTickerStep && !bUseSharedTicker", ClampMin = 1))
+	float TickerStepRate = 120.f;
+
+	/** Максимум шагов тикера за кадр, ограничивает стоимость догоняния после фриза */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ticker", meta = (EditCondition = "bFixedTickerStep && !bUseSharedTicker", ClampMin = 1))
+	int32 TickerMaxSubSteps = 4;
+
+	/** Бюджет тикера на кадр в микросекундах, при его исчерпании обновление способностей продолжится в следующем кадре. 0 - без ограничения */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ticker", meta = (EditCondition = "!bUseSharedTicker", ClampMin = 0))
+	float TickerFrameBudget = 0.f;
+
+	/**
+	 * Обновлять способности, отложенные функции и корутины в группе PrePhysics тика мира, а не в тикере движка.
+	 * Так изменения способностей применяются в том же кадре до компонентов движения. Фиксированный шаг в этом режиме не действует.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ticker", meta = (EditCondition = "!bUseSharedTicker"))
+	bool bTickInPrePhysics = false;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Attributes")
 	TSet<TSubclassOf<UAttribute>> RegisteredAttributes;
 
@@ -100,10 +144,13 @@ protected:
 
 	virtual void OnAbilityActivated(UDynamicAbility* Ability, const UObject* Activator);
 	
-	virtual bool UpdateAbility(const FName& Key, const float DeltaTime);
+	virtual bool UpdateAbility(const FAbilityHandle& Handle, const float DeltaTime);
+
+	/** Вызывается модулем обновления, когда у слайда способности закончилось MaxActiveTime */
+	virtual void OnAbilityUpdateExpired(const FAbilityHandle& Handle);
 
 	virtual bool ValidateSlideChange(const FAbilitySlideSettings& SlideSettings) const;
-	virtual bool OnAbilitySlideChanged(UDynamicAbility* Ability, const FGameplayTag& SlideName);
+	virtual bool OnAbilitySlideChanged(UDynamicAbility* Ability, const int32 SlideId);
 	
 	virtual bool DisableAbility(UDynamicAbility* Ability, const EDisableType& DisableType, const UObject* Disabler, const FGameplayTag& DisableReason);
 	virtual void OnAbilityDisabled(UDynamicAbility* Ability, const EDisableType& DisableType, const UObject* Disabler, const FGameplayTag& DisableReason);
@@ -117,25 +164,199 @@ protected:
 		}
 		if (Ability->bMustSearchSettings)
 		{
-			Ability->AbilitySettings = *AbilitiesSettings->FindRow<FDynamicAbilitySettings>(Key, TEXT("Cannot find settings for ability"));
+			// строку в способность не копируем, её настройки собираются один раз и общие для всех экземпляров
+			const auto* Settings = AbilitiesSettings->FindRow<FDynamicAbilitySettings>(Key, TEXT("Cannot find settings for ability"));
+			Ability->SharedSettings = FSharedAbilitySettings::FindOrCompile(*Settings, AbilitiesSettings, Key);
 			return true;
 		}
+		Ability->SharedSettings = FSharedAbilitySettings::FindOrCompile(Ability->AbilitySettings, Ability->GetClass());
 		return false;
 	}
 
+	/** Обёртки над модулями тикера, направляют задачи либо в модули системы, либо в общий тикер мира */
+	TInvoker<void()>* AddAbilityDelayedFun(const FAbilityHandle& Handle, const float DelaySeconds);
+	void RemoveAbilityDelayedFun(const FAbilityHandle& Handle);
+	void ReSetAbilityUpdate(const FAbilityHandle& Handle, const float UpdateRate, const float MaxActiveTime);
+	void EndAbilityUpdate(const FAbilityHandle& Handle);
+	TOptional<FUpdateAbilityTickerData> GetAbilityUpdateTask(const FAbilityHandle& Handle) const;
+	FCoroutineTickerModule* GetAbilityCoroutineModule();
+
+	/** Пул способностей мира, если система им пользуется */
+	UDynamicAbilityPoolSubsystem* GetAbilityPool() const;
+
+	/**
+	 * Ставит тик компонента после обновления способностей в PrePhysics, своего или общего тикера мира.
+	 * Возвращает false, если способности обновляются тикером движка и порядок с тиком мира не задать.
+	 */
+	bool AddAbilityTickPrerequisite(FTickFunction& DependentTickFunction);
+
+	/** Отменяет все корутины способности */
+	void CancelAbilityTasks(UDynamicAbility* Ability);
+
+	/** Добавляет и убирает по одной ссылке на теги системы, корутины, ждущие тега, возобновляются при его появлении */
+	void AddOwnedTags(const FDASTagSet& Tags);
+	void RemoveOwnedTags(const FDASTagSet& Tags);
+
+	/** Вызывается только когда тег появляется у системы или пропадает */
+	void OnOwnedTagChanged(const FGameplayTag& Tag, bool bAdded);
+
+	/** Выдаёт и снимает теги слайда способности: теги системы и индекс GrantedTagAbilities */
+	void GrantAbilityTags(const UDynamicAbility* Ability, const FDASTagSet& Tags);
+	void RevokeAbilityTags(const UDynamicAbility* Ability, const FDASTagSet& Tags);
+
+	/** Записывает и убирает теги способности только в индексе GrantedTagAbilities, без тегов системы */
+	void IndexAbilityTags(const UDynamicAbility* Ability, const FDASTagSet& Tags);
+	void UnindexAbilityTags(const UDynamicAbility* Ability, const FDASTagSet& Tags);
+
+	/**
+	 * Способности, выдавшие тег, по номеру тега FDASTagRegistry. Способность записана под каждым своим тегом и всеми его родителями,
+	 * столько раз, сколько её слайды выдали тег, поэтому OverrideAbilities смотрит только корзины тегов замены.
+	 * Теги базового слайда попадают сюда уже с начала задержки активации, хотя системе выдаются только после неё.
+	 */
+	TArray<TArray<FAbilityHandle, TInlineAllocator<2>>> GrantedTagAbilities;
+
+	/** Подписывает активную способность на её InputsKeys и отписывает при выключении */
+	void SubscribeAbilityInputs(const UDynamicAbility* Ability);
+	void UnsubscribeAbilityInputs(const UDynamicAbility* Ability);
+
+	/** Копия подписчиков ввода: способность может выключиться в обработчике ввода и изменить список */
+	TArray<FAbilityHandle, TInlineAllocator<4>> CopyInputSubscribers(const FGameplayTag& InputKey) const;
+
+	/** Активные способности, слушающие ввод, по номеру тега ввода FDASTagRegistry */
+	TArray<TArray<FAbilityHandle, TInlineAllocator<2>>> InputSubscribers;
+
+	/** Сколько вводов не обработала ни одна способность, вместо лога на каждый такой ввод */
+	int32 UnhandledInputCount = 0;
+
+	/** Вид команды очереди: выключения разбираются первыми, остальные команды - в порядке вызова */
+	enum class EAbilityCommandType : uint8
+	{
+		Disable,
+		Slide,
+		Activate
+	};
+
+	/** Команда способности, отложенная до разбора очереди */
+	struct FAbilityCommand
+	{
+		EAbilityCommandType Type;
+		FAbilityHandle Handle;
+		int32 SlideId = INDEX_NONE;
+		TWeakObjectPtr<const UObject> Instigator;
+		FGameplayTag DisableReason;
+	};
+
+	/** Команды текущего кадра и буфер разбираемой пачки */
+	TArray<FAbilityCommand> AbilityCommands;
+	TArray<FAbilityCommand> ResolvingAbilityCommands;
+
+	/** Способность, запущенная во время разбора пачки, по порядку запуска решается, кого заменяет её замена */
+	struct FBatchActivation
+	{
+		FAbilityHandle Handle;
+
+		/** Активирована сразу и заменяет другие, способность на задержке активации только занимает место в порядке */
+		bool bOverrider = false;
+	};
+
+	/** Способности, запущенные во время разбора, замена для них выполняется одним проходом после пачки */
+	TArray<FBatchActivation, TInlineAllocator<8>> BatchActivations;
+
+	/** Теги системы на момент проверки пачки, ValidateSlideChange смотрит в них вместо текущих тегов */
+	FDASTagSet TagSnapshot;
+	bool bUseTagSnapshot = false;
+	bool bResolvingAbilityCommands = false;
+
+	/** Ставит команду в очередь и будит модуль очереди */
+	bool QueueAbilityCommand(FAbilityCommand&& Command);
+
+	/** Разбирает накопленные команды одним проходом, вызывается модулем очереди */
+	void ResolveAbilityCommands();
+	FAbilityCommandTickerModule* GetAbilityCommandModule();
+
+	/** Корутина, ждущая тег, и модуль, который её выполняет */
+	struct FTagWaiter
+	{
+		FGameplayTag Tag;
+		FCoroutineTickerModule* Module;
+		FTickerTaskHandle Handle;
+	};
+	TArray<FTagWaiter> TagWaiters;
+
 #if WITH_TOUCH
 	TWeakObjectPtr<UTouchManager> TouchManager;
 #endif
 #if WITH_ROTO
 	TWeakObjectPtr<ARotoCameraManager> RotoManager;
 #endif
-	FGameplayTagContainer OwnedTags;
+	TWeakObjectPtr<UDynamicAbilityTickerSubsystem> SharedTicker;
+	FDASTagCountSet OwnedTags;
 	TMap<FName, TWeakObjectPtr<UObject>> ContextObjects;
 	TMap<TSubclassOf<UAttribute>, TStrongObjectPtr<UAttribute>> Attributes;
-	TMap<FName, TStrongObjectPtr<UDynamicAbility>> CurrentAbilities;
+
+	/** Ячейка таблицы способностей, ячейки удалённых способностей переиспользуются с новым поколением */
+	struct FAbilitySlot
+	{
+		TStrongObjectPtr<UDynamicAbility> Ability;
+		FName Key;
+		uint32 Serial = 0;
+	};
+
+	/** Способности системы по индексу хендла */
+	TArray<FAbilitySlot> AbilitySlots;
+	TArray<int32> FreeAbilitySlots;
+
+	/** Хендлы способностей по ключу, слой для Blueprint и FName API поверх таблицы */
+	TMap<FName, FAbilityHandle> AbilityHandles;
+
+	/** Кладёт способность в свободную ячейку и выдаёт ей хендл */
+	FAbilityHandle AllocateAbilitySlot(const FName Key, UDynamicAbility* Ability);
+	void ReleaseAbilitySlot(const FAbilityHandle& Handle);
 public:
-	FORCEINLINE const TMap<FName, TStrongObjectPtr<UDynamicAbility>>& GetAbilities() const { return CurrentAbilities; }
-	FORCEINLINE const FGameplayTagContainer& GetOwnedTags() { return OwnedTags; }
+	/** Теги системы контейнером, для Blueprint и окна отладки */
+	FORCEINLINE FGameplayTagContainer GetOwnedTags() const { return OwnedTags.GetTagSet().ToContainer(); }
+	FORCEINLINE const FDASTagSet& GetOwnedTagSet() const { return OwnedTags.GetTagSet(); }
+
+	/** Сколько способностей сейчас выдают тег */
+	FORCEINLINE int32 GetOwnedTagCount(const FGameplayTag& Tag) const { return OwnedTags.GetTagCount(Tag); }
+
+	/** Тег появился у системы (bAdded) или пропал, повторная выдача уже имеющегося тега не оповещает */
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnOwnedTagChangedDelegate, const FGameplayTag& /*Tag*/, bool /*bAdded*/);
+	FOnOwnedTagChangedDelegate OnOwnedTagChangedDelegate;
+
+	/** Способность по хендлу или nullptr, если она уже удалена */
+	FORCEINLINE UDynamicAbility* FindAbility(const FAbilityHandle& Handle) const
+	{
+		return AbilitySlots.IsValidIndex(Handle.Index) && AbilitySlots[Handle.Index].Serial == Handle.Serial ? AbilitySlots[Handle.Index].Ability.Get() : nullptr;
+	}
+	FORCEINLINE FAbilityHandle FindAbilityHandle(const FName Key) const
+	{
+		const FAbilityHandle* Handle = AbilityHandles.Find(Key);
+		return Handle ? *Handle : FAbilityHandle();
+	}
+	FORCEINLINE UDynamicAbility* FindAbility(const FName Key) const { return FindAbility(FindAbilityHandle(Key)); }
+	FORCEINLINE int32 GetAbilityCount() const { return AbilityHandles.Num(); }
+
+	/** Вызывает Function(Key, Ability) для каждой способности системы, способности можно добавлять и удалять прямо из Function */
+	template<typename FunctionT>
+	void ForEachAbility(FunctionT Function) const
+	{
+		for (int32 Index = 0; Index < AbilitySlots.Num(); ++Index)
+		{
+			// копия ключа, так как добавление способности из Function может переложить таблицу
+			if (UDynamicAbility* Ability = AbilitySlots[Index].Ability.Get()) Function(FName(AbilitySlots[Index].Key), Ability);
+		}
+	}
+
+	/** Запускает корутину способности на тикере системы (или общем тикере мира), корутина отменяется при выключении способности */
+	FTickerTaskHandle RunAbilityTask(UDynamicAbility* Ability, FTickerTask&& Task);
+
+	/**
+	 * Потокобезопасные варианты добавления задач тикера для async колбэков и воркеров.
+	 * Задача ставится в очередь команд тикера и добавляется на игровом потоке, если система к тому моменту ещё жива.
+	 */
+	void EnqueueAbilityDelayedFun(const FAbilityHandle& Handle, const float DelaySeconds, TInvoker<void()>&& Fun);
+	void EnqueueAbilityUpdate(const FAbilityHandle& Handle, const float UpdateRate, const float MaxActiveTime);
 	
 	UPROPERTY(BlueprintAssignable)
 	FOnAddedAbility OnAddedAbility;
@@ -145,12 +366,14 @@ public:
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool AddAbility(const TSubclassOf<UDynamicAbility> AbilityClass, const UObject* Adder)
 	{
-		return AddAbility(FindAbilityCDO(AbilityClass)->AbilityName, AbilityClass, Adder);
+		return AddAbility(FindAbilityCDO(AbilityClass)->AbilityName, AbilityClass, Adder).IsValid();
 	}
-	virtual bool AddAbility(const FName Key, const TSubclassOf<UDynamicAbility>& AbilityClass, const UObject* Adder);
+	/** Добавляет способность под ключом Key, возвращает её хендл или пустой хендл, если способность не добавлена */
+	virtual FAbilityHandle AddAbility(const FName Key, const TSubclassOf<UDynamicAbility>& AbilityClass, const UObject* Adder);
 
 	UFUNCTION(BlueprintCallable)
 	bool RemoveAbility(const FName Key, const UObject* Remover);
+	bool RemoveAbility(const FAbilityHandle& Handle, const UObject* Remover);
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool RemoveAbilityByClass(const TSubclassOf<UDynamicAbility>& AbilityClass, const UObject* Remover)
 	{
@@ -159,6 +382,7 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	bool ActivateAbility(const FName Key, const UObject* Activator);
+	bool ActivateAbility(const FAbilityHandle& Handle, const UObject* Activator);
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool ActivateAbilityByClass(const TSubclassOf<UDynamicAbility>& AbilityClass, const UObject* Activator)
 	{
@@ -168,9 +392,10 @@ public:
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool ForcedAbilityDisable(const FName Key, const UObject* Disabler, const FGameplayTag& DisableReason)
 	{
-		if (const auto AbilityStorage = CurrentAbilities.Find(Key))
+		if (UDynamicAbility* Ability = FindAbility(Key))
 		{
-			return DisableAbility(AbilityStorage->Get(), EDisableType::Forced, Disabler, DisableReason);
+			if (bQueueAbilityCommands) return QueueAbilityCommand({ EAbilityCommandType::Disable, Ability->AbilityHandle, INDEX_NONE, Disabler, DisableReason });
+			return DisableAbility(Ability, EDisableType::Forced, Disabler, DisableReason);
 		}
 		return false;
 	}
@@ -183,30 +408,36 @@ public:
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool ChangeAbilitySlide(const FName Key, const FGameplayTag& SlideName)
 	{
-		if (const auto AbilityStorage = CurrentAbilities.Find(Key))
-		{
-			return ChangeAbilitySlide(AbilityStorage->Get(), SlideName);
-		}
+		if (UDynamicAbility* Ability = FindAbility(Key)) return ChangeAbilitySlide(Ability, SlideName);
 		return false;
 	}
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool ChangeAbilitySlideByClass(const TSubclassOf<UDynamicAbility>& AbilityClass, const FGameplayTag& SlideName)
 	{
-		for (const auto& AbilityData : CurrentAbilities)
+		for (const FAbilitySlot& Slot : AbilitySlots)
 		{
-			if (AbilityData.Value->GetClass() != AbilityClass) return false;
-			return ChangeAbilitySlide(AbilityData.Value.Get(), SlideName);
+			if (Slot.Ability && Slot.Ability->GetClass() == AbilityClass) return ChangeAbilitySlide(Slot.Ability.Get(), SlideName);
 		}
 		return false;
 	}
 	
 	bool ChangeAbilitySlide(UDynamicAbility* Ability, const FGameplayTag& SlideName);
 
+	/**
+	 * Переопределяет поле слайда только у этой способности, общие настройки остальных экземпляров не меняются.
+	 * Новое значение действует со следующего входа в слайд.
+	 */
+	bool SetAbilitySlideOverride(const FAbilityHandle& Handle, const FGameplayTag& SlideName, const EAbilitySlideField Field, const float Value);
+	void ResetAbilitySlideOverrides(const FAbilityHandle& Handle);
+
 	UFUNCTION(Blueprintable)
 	void AddAbilityInput(const FGameplayTag& InputKey, const ETriggerEvent& Event);
 
 	UFUNCTION(Blueprintable)
 	void AddAbilityInputVector(const FVector& WorldVector, const FGameplayTag& InputKey, const ETriggerEvent& Event);
+
+	/** Сколько вводов пришло в систему, когда их не слушала ни одна активная способность */
+	FORCEINLINE int32 GetUnhandledInputCount() const { return UnhandledInputCount; }
 	
 	
 	UFUNCTION(Blueprintable)
@@ -266,11 +497,20 @@ public:
 		return AttributesWithAllAllows.Contains(Ability->GetClass()) && Ability->bGetAllAllows;
 	}
 protected:
-	void OverrideAbilities(const UDynamicAbility* Overrider);	
+	void OverrideAbilities(const UDynamicAbility* Overrider);
+
+	/**
+	 * Замена для пачки способностей одним проходом с тем же результатом, что и при немедленных вызовах в порядке пачки:
+	 * способность заменяет все способности с тегами замены, кроме запущенных в пачке после неё.
+	 */
+	void OverrideAbilities(TConstArrayView<FBatchActivation> Activations);
+
+	/** Проверки и активация способности без очереди команд */
+	bool TryActivateAbility(UDynamicAbility* Ability, const UObject* Activator);
 	
 	FORCEINLINE static bool CheckAbilitySlide(const UDynamicAbility* Ability, const FGameplayTag& SlideName)
 	{
-		return Ability ? Ability->CurrentSlideType == SlideName : false;
+		return Ability ? Ability->GetCurrentSlideTag() == SlideName : false;
 	}
 	FORCEINLINE static const UDynamicAbility* FindAbilityCDO(const TSubclassOf<UDynamicAbility>& AbilityClass)
 	{ 
@@ -279,6 +519,24 @@ protected:
 		return nullptr;
 	}
 	
-	static const FAbilitySlideSettings* FindSlideData(const UDynamicAbility* Ability, const ESlideSettingsType& SettingsType = ESlideSettingsType::Auto,
-		const bool bEnsureResult = false, const FGameplayTag& SlideName = FGameplayTag::EmptyTag);
+	/** Смена слайда по номеру в таблице слайдов способности, ChangeAbilitySlide по тегу сводится к ней */
+	bool ChangeAbilitySlideById(UDynamicAbility* Ability, const int32 SlideId);
+
+	FORCEINLINE static const FAbilitySlideSettings& GetSlideData(const UDynamicAbility* Ability, const int32 SlideId)
+	{
+		return Ability->SharedSettings->GetSlide(SlideId);
+	}
+	FORCEINLINE static const FAbilitySlideSettings& GetCurrentSlideData(const UDynamicAbility* Ability)
+	{
+		return Ability->SharedSettings->GetSlide(Ability->CurrentSlideId);
+	}
+
+	/** Время слайда с переопределениями способности, по нему система ставит задержки и обновление */
+	FORCEINLINE static FAbilitySlideTimings GetSlideTimings(const UDynamicAbility* Ability, const int32 SlideId)
+	{
+		return Ability->SharedSettings->GetSlideTimings(SlideId, Ability->SlideOverrides);
+	}
+
+	/** Ставит обновление способности по времени слайда, если оно у слайда есть */
+	void StartSlideUpdate(UDynamicAbility* Ability, const FAbilitySlideTimings& Timings);
 };
\ No newline at end of file
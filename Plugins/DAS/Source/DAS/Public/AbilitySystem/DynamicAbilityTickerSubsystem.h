@@ -0,0 +1,51 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StaticTickerManager.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "DynamicAbilityTickerSubsystem.generated.h"
+
+class FSharedAbilityUpdateTickerModule;
+class FSharedFunHolderTickerModule;
+class FCoroutineTickerModule;
+class FAbilityCommandTickerModule;
+class UDynamicAbilitySystem;
+
+/**
+ * Общий тикер способностей мира.
+ * Системы с включённым bUseSharedTicker не создают свои модули и свой тикер, а кладут задачи в общие таблицы этой подсистемы,
+ * поэтому все способности мира обновляются одним тикером в одном цикле.
+ */
+UCLASS(Config = Game)
+class DAS_API UDynamicAbilityTickerSubsystem : public UWorldSubsystem, public FStaticTickerManager
+{
+	GENERATED_BODY()
+
+	FSharedFunHolderTickerModule* FunHolderModule = nullptr;
+	FSharedAbilityUpdateTickerModule* AbilityUpdateModule = nullptr;
+	FCoroutineTickerModule* CoroutineModule = nullptr;
+	FAbilityCommandTickerModule* CommandModule = nullptr;
+
+	/** Бюджет общего тикера на кадр в микросекундах, 0 - без ограничения */
+	UPROPERTY(Config)
+	float FrameBudget = 0.f;
+
+	/** Обновлять общие модули в группе PrePhysics тика мира, до компонентов движения */
+	UPROPERTY(Config)
+	bool bTickInPrePhysics = false;
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	FORCEINLINE FSharedFunHolderTickerModule* GetFunHolderModule() const { return FunHolderModule; }
+	FORCEINLINE FSharedAbilityUpdateTickerModule* GetAbilityUpdateModule() const { return AbilityUpdateModule; }
+	FORCEINLINE FCoroutineTickerModule* GetCoroutineModule() const { return CoroutineModule; }
+	FORCEINLINE FAbilityCommandTickerModule* GetCommandModule() const { return CommandModule; }
+
+	/** Удаляет все задачи системы из общих таблиц, вызывается системой при завершении работы */
+	void RemoveSystemTasks(const UDynamicAbilitySystem* System) const;
+};
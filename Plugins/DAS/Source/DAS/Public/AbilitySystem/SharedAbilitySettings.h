@@ -0,0 +1,60 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DynamicAbility.h"
+
+/** Время слайда с учётом переопределений экземпляра способности */
+struct FAbilitySlideTimings
+{
+	float ActivationDelay = 0.f;
+	float UpdateAbilityRate = 0.f;
+	float MaxActiveTime = 0.f;
+	bool bTickEveryFrame = false;
+};
+
+/**
+ * Настройки способности, собранные из FDynamicAbilitySettings один раз на источник (класс способности или строку таблицы)
+ * и общие для всех экземпляров через FAbilitySettingsRegistry. Неизменяемые: отличия отдельной способности
+ * хранятся в ней самой как FAbilitySlideOverride и накладываются через GetSlideTimings.
+ * Слайды лежат плоским массивом и адресуются небольшим номером, переходы между слайдами - чтение из массива вместо поиска в TMap по тегу.
+ */
+class DAS_API FSharedAbilitySettings
+{
+	/** Настройки слайдов с собранными наборами тегов, [BaseSlideId] - базовый слайд */
+	TArray<FAbilitySlideSettings> Slides;
+
+	/** Тег слайда по номеру, у базового слайда тег пустой */
+	TArray<FGameplayTag> SlideTags;
+public:
+	/** Номер базового слайда */
+	static constexpr int32 BaseSlideId = 0;
+
+	explicit FSharedAbilitySettings(const FDynamicAbilitySettings& Settings);
+
+	/** Настройки Settings из источника Source (класс способности или таблица данных) и строки Row, собираются при первом обращении */
+	static TSharedRef<const FSharedAbilitySettings> FindOrCompile(const FDynamicAbilitySettings& Settings, const UObject* Source, const FName Row = NAME_None);
+
+	bool bActivateAbilityOnGranted = false;
+	TArray<FGameplayTag> InputsKeys;
+
+	/** Номера InputsKeys в FDASTagRegistry, по ним система подписывает способность на ввод */
+	TArray<int32> InputTagIndexes;
+
+	/** OverrideTags способности */
+	FDASTagSet OverrideTagSet;
+
+	/** Номер слайда по тегу, пустой тег - базовый слайд. INDEX_NONE, если такого слайда нет */
+	FORCEINLINE int32 FindSlideId(const FGameplayTag& SlideTag) const
+	{
+		// слайдов у способности единицы, линейный поиск по плотному массиву дешевле хеша
+		return SlideTags.IndexOfByKey(SlideTag);
+	}
+
+	FORCEINLINE const FAbilitySlideSettings& GetSlide(const int32 SlideId) const { return Slides[SlideId]; }
+	FORCEINLINE const FGameplayTag& GetSlideTag(const int32 SlideId) const { return SlideTags[SlideId]; }
+	FORCEINLINE int32 GetSlideCount() const { return Slides.Num(); }
+
+	/** Время слайда с наложенными переопределениями экземпляра */
+	FAbilitySlideTimings GetSlideTimings(const int32 SlideId, TConstArrayView<FAbilitySlideOverride> Overrides) const;
+};
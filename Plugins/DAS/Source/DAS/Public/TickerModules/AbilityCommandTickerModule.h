@@ -0,0 +1,36 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TickerModule.h"
+
+class UDynamicAbilitySystem;
+
+/**
+ * Модуль очереди команд способностей. Системы с bQueueAbilityCommands копят активации, выключения и смены слайдов за кадр,
+ * а модуль разбирает очередь каждой такой системы одним проходом. Модуль обновляется раньше остальных модулей своего менеджера,
+ * поэтому команды кадра применяются до отложенных функций и обновления способностей.
+ * Один модуль обслуживает как одну систему, так и все системы общего тикера мира.
+ */
+class DAS_API FAbilityCommandTickerModule : public FTickerModule
+{
+	GENERATED_TICKER_BODY("AbilityCommandTickerModule")
+
+	/** Системы, у которых есть команды, каждая записана один раз */
+	TArray<TWeakObjectPtr<UDynamicAbilitySystem>> PendingSystems;
+
+	/** Переиспользуемый буфер систем текущего тика, команды, поставленные во время разбора, уходят в следующий тик */
+	TArray<TWeakObjectPtr<UDynamicAbilitySystem>> ResolvingSystems;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool NeedUpdate() const override { return !PendingSystems.IsEmpty(); }
+	virtual int32 GetActiveTaskCount() const override { return PendingSystems.Num(); }
+public:
+	FAbilityCommandTickerModule()
+	{
+		TickPriority = -1;
+	}
+
+	/** Ставит систему на разбор её очереди в ближайшем тике модуля */
+	void AddPendingSystem(UDynamicAbilitySystem* System);
+};
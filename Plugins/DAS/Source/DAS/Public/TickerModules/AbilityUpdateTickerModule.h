@@ -1,104 +1,396 @@
-﻿
-#pragma once
+﻿#pragma once
 
 #include "CoreMinimal.h"
 #include "TickerModule.h"
 #include "Utility/Invoker.h"
+#include "Algo/BinarySearch.h"
+#include "AbilitySystem/AbilityHandle.h"
 
+/** Снимок состояния задачи обновления способности, таблица модуля хранит эти поля в отдельных массивах */
 struct FUpdateAbilityTickerData
 {
-	FUpdateAbilityTickerData(const float InUpdateRate, const float MaxActiveTime)
-		: UpdateRate(InUpdateRate)
-	   , MaxActiveTime(MaxActiveTime) {}
-	
-	float UpdateRate;
-	float MaxActiveTime;
-	float UpdateLoopRemainingTime = 0.0f;
-	float RemainingTime = 0.0f;
+	float UpdateRate = 0.f;
+	float MaxActiveTime = 0.f;
+	float UpdateLoopRemainingTime = 0.f;
+	float RemainingTime = 0.f;
+};
+
+/** Стабильный хендл задачи обновления: не меняется при перекладывании задач в таблице и не совпадает с хендлом прошлой задачи в той же ячейке */
+struct FAbilityUpdateHandle
+{
+	int32 Slot = INDEX_NONE;
+	uint32 Serial = 0;
+
+	FORCEINLINE bool IsValid() const { return Slot != INDEX_NONE; }
+	FORCEINLINE bool operator==(const FAbilityUpdateHandle& Other) const { return Slot == Other.Slot && Serial == Other.Serial; }
 };
 
 class UDynamicAbility;
 
-class DAS_API FAbilityUpdateTickerModule : public FTickerModule
+/**
+ * Модуль обновления способностей во времени.
+ * Тип ключа задачи задаётся шаблоном, чтобы одна таблица могла обслуживать как одну систему (FAbilityHandle), так и все системы мира.
+ * Задачи лежат в плотной таблице по столбцам: таймеры всех задач обновляются одним проходом без ветвлений,
+ * а вызовы получают только задачи из буфера готовых. Удаление перекладывает последнюю задачу на место удалённой,
+ * снаружи задача адресуется ключом или хендлом, который не зависит от её места в таблице.
+ * Если бюджет кадра менеджера закончился, вызовы прерываются и продолжаются со следующей готовой задачи на следующем тике.
+ */
+template<typename KeyT>
+class TAbilityUpdateTickerModule : public FTickerModule
 {
-	GENERATED_TICKER_BODY("AbilityUpdateTickerModule")
-	
-	using FAbilityUpdateInvoker = TInvoker<bool(const FName&, float)>;
-	using FDisableAbilityInvoker = TInvoker<void(const FName&)>;
+	using FAbilityUpdateInvoker = TInvoker<bool(const KeyT&, float)>;
+	using FDisableAbilityInvoker = TInvoker<void(const KeyT&)>;
+
+	/** Флаги задачи в TaskStates */
+	static constexpr uint8 TaskDue = 1 << 0;
+	static constexpr uint8 TaskExpired = 1 << 1;
+	static constexpr uint8 TaskRemoved = 1 << 2;
+
+	/** MaxActiveTime без ограничения хранится как максимум float, чтобы проверка истечения не ветвилась */
+	static constexpr float UnlimitedActiveTime = TNumericLimits<float>::Max();
 
 	virtual void Tick(float DeltaTime) override
 	{
-		TMap<FName, bool /* bCallDisableAbilityInvoker */> CompletedTasks;
-		for (auto& TaskData : UpdateTasks)
+		CurrentTime += DeltaTime;
+		const int32 TaskCount = TaskKeys.Num();
+
+		// проход по таймерам: только столбцы float без вызовов и ветвлений, компилятор может его векторизовать
+		float MinDelay = TNumericLimits<float>::Max();
 		{
-			const auto& Key = TaskData.Key;
-			auto& Settings = TaskData.Value;
+			float* RESTRICT Loops = LoopElapsed.GetData();
+			float* RESTRICT Actives = ActiveElapsed.GetData();
+			double* RESTRICT LastTimes = LastProcessedTimes.GetData();
+			uint8* RESTRICT States = TaskStates.GetData();
+			const float* RESTRICT Rates = UpdateRates.GetData();
+			const float* RESTRICT MaxTimes = MaxActiveTimes.GetData();
+			for (int32 Index = 0; Index < TaskCount; ++Index)
+			{
+				const float Loop = Loops[Index] + DeltaTime;
+				const float Active = Actives[Index] + DeltaTime;
+				Loops[Index] = Loop;
+				Actives[Index] = Active;
 
-			Settings.RemainingTime += DeltaTime;
-			Settings.UpdateLoopRemainingTime += DeltaTime;
+				const bool bExpired = Active >= MaxTimes[Index];
+				const bool bDue = bExpired | (Loop >= Rates[Index]);
+				States[Index] = static_cast<uint8>(static_cast<uint8>(bDue) * TaskDue | static_cast<uint8>(bExpired) * TaskExpired);
 
-			if (Settings.MaxActiveTime != 0.f && Settings.RemainingTime >= Settings.MaxActiveTime)
+				// готовые задачи пересчитают задержку после вызова, задачи без вызова считаются обработанными в этом тике
+				const float Delay = FMath::Min(Rates[Index] - Loop, MaxTimes[Index] - Active);
+				MinDelay = FMath::Min(MinDelay, bDue ? TNumericLimits<float>::Max() : Delay);
+				LastTimes[Index] = bDue ? LastTimes[Index] : CurrentTime;
+			}
+		}
+
+		DueTasks.Reset();
+		for (int32 Index = 0; Index < TaskCount; ++Index)
+		{
+			if (TaskStates[Index]) DueTasks.Add(Index);
+		}
+
+		// обход готовых задач продолжается с задачи, на которой его прервал бюджет прошлого тика
+		const int32 DueCount = DueTasks.Num();
+		const int32 ResumeIndex = FindTaskIndex(ResumeHandle);
+		const int32 FirstDue = DueCount != 0 && ResumeIndex != INDEX_NONE ? Algo::LowerBound(DueTasks, ResumeIndex) % DueCount : 0;
+
+		bIteratingTasks = true;
+		int32 ProcessedCount = 0;
+		for (; ProcessedCount < DueCount; ++ProcessedCount)
+		{
+			if (ProcessedCount != 0 && !HasFrameBudget()) break; // хотя бы одна задача за тик, иначе обход не сдвинется
+			const int32 Index = DueTasks[(FirstDue + ProcessedCount) % DueCount];
+			if (TaskStates[Index] & TaskRemoved) continue;
+
+			if (TaskStates[Index] & TaskExpired)
 			{
-				CompletedTasks.Add(Key, true);
+				ExpiredTasks.Add(TaskKeys[Index]);
+				RemoveTask(Index);
 				continue;
 			}
-			if (Settings.UpdateLoopRemainingTime >= Settings.UpdateRate)
+
+			const float TaskDeltaTime = static_cast<float>(CurrentTime - LastProcessedTimes[Index]);
+			LastProcessedTimes[Index] = CurrentTime;
+			LoopElapsed[Index] = 0.f;
+
+			// копия ключа, так как invoker может добавить задачи и переложить массивы
+			if (const KeyT Key = TaskKeys[Index]; !AbilityUpdateInvoker(Key, TaskDeltaTime))
 			{
-				Settings.UpdateLoopRemainingTime = 0.f;
- 				if (!AbilityUpdateInvoker(Key, DeltaTime)) CompletedTasks.Add(Key, false);
+				if (!(TaskStates[Index] & TaskRemoved)) RemoveTask(Index);
+				continue;
 			}
+			if (TaskStates[Index] & TaskRemoved) continue;
+			MinDelay = FMath::Min(MinDelay, FMath::Min(UpdateRates[Index], MaxActiveTimes[Index] - ActiveElapsed[Index]));
 		}
-		for (auto Key : CompletedTasks)
+		bIteratingTasks = false;
+
+		const int32 DeferredCount = DueCount - ProcessedCount;
+		ResumeHandle = DeferredCount != 0 ? MakeTaskHandle(DueTasks[(FirstDue + ProcessedCount) % DueCount]) : FAbilityUpdateHandle();
+		NextUpdateDelay = MinDelay;
+		CompactRemovedTasks();
+
+		ReportDeferredWork(DeferredCount);
+		if (DeferredCount != 0) RequestNextSlice();
+
+		// вызываем DisableAbilityInvoker только после обхода, так как он может изменять задачи
+		for (const KeyT& Key : ExpiredTasks)
 		{
-			UpdateTasks.Remove(Key.Key);
-			if (Key.Value) // вызываем DisableAbilityInvoker только тут, а не в for по UpdateTasks изо того что DisableAbilityInvoker может изменять UpdateTasks
-			{
-				DisableAbilityInvoker(Key.Key);
-				TryEndTickerSave();
-			}
+			DisableAbilityInvoker(Key);
+			TryEndTickerSave();
 		}
+		ExpiredTasks.Reset();
 	}
 
 	virtual bool NeedUpdate() const override
 	{
-		return !UpdateTasks.IsEmpty();
+		return !KeySlots.IsEmpty();
+	}
+
+	virtual int32 GetActiveTaskCount() const override
+	{
+		return KeySlots.Num();
+	}
+
+	virtual double GetNextUpdateDelay() const override
+	{
+		return FMath::Max(NextUpdateDelay, 0.f);
+	}
+
+	FAbilityUpdateHandle AddTask(const KeyT& Key, const float UpdateRate, const float MaxActiveTime)
+	{
+		// модуль мог проспать до дальнего дедлайна, и ближайший тик добавит всё это время всем задачам,
+		// поэтому новая задача начинает с отрицательным временем и получает только время после добавления
+		const double SleptTime = GetTimeSinceLastTick();
+		const int32 Index = TaskKeys.Add(Key);
+		UpdateRates.Add(UpdateRate);
+		MaxActiveTimes.Add(MaxActiveTime != 0.f ? MaxActiveTime : UnlimitedActiveTime);
+		LoopElapsed.Add(static_cast<float>(-SleptTime));
+		ActiveElapsed.Add(static_cast<float>(-SleptTime));
+		LastProcessedTimes.Add(CurrentTime + SleptTime);
+		TaskStates.Add(0);
+
+		int32 Slot;
+		if (!FreeSlots.IsEmpty()) Slot = FreeSlots.Pop(EAllowShrinking::No);
+		else
+		{
+			Slot = SlotTaskIndexes.Add(INDEX_NONE);
+			SlotSerials.Add(0);
+		}
+		SlotTaskIndexes[Slot] = Index;
+		TaskSlots.Add(Slot);
+		KeySlots.Add(Key, Slot);
+		return MakeTaskHandle(Index);
+	}
+
+	/**
+	 * Убирает задачу из поиска по ключу и хендлу. Вне обхода задача сразу удаляется перестановкой последней задачи на её место,
+	 * во время обхода только помечается и удаляется в CompactRemovedTasks, чтобы не сдвигать индексы готовых задач.
+	 */
+	void RemoveTask(const int32 Index)
+	{
+		const int32 Slot = TaskSlots[Index];
+		SlotTaskIndexes[Slot] = INDEX_NONE;
+		++SlotSerials[Slot];
+		FreeSlots.Add(Slot);
+		KeySlots.Remove(TaskKeys[Index]);
+
+		if (!bIteratingTasks)
+		{
+			RemoveTaskAtSwap(Index);
+			return;
+		}
+		TaskStates[Index] |= TaskRemoved;
+		++RemovedTaskCount;
+	}
+
+	void RemoveTaskAtSwap(const int32 Index)
+	{
+		TaskKeys.RemoveAtSwap(Index, EAllowShrinking::No);
+		TaskSlots.RemoveAtSwap(Index, EAllowShrinking::No);
+		UpdateRates.RemoveAtSwap(Index, EAllowShrinking::No);
+		MaxActiveTimes.RemoveAtSwap(Index, EAllowShrinking::No);
+		LoopElapsed.RemoveAtSwap(Index, EAllowShrinking::No);
+		ActiveElapsed.RemoveAtSwap(Index, EAllowShrinking::No);
+		LastProcessedTimes.RemoveAtSwap(Index, EAllowShrinking::No);
+		TaskStates.RemoveAtSwap(Index, EAllowShrinking::No);
+		if (Index < TaskKeys.Num()) SlotTaskIndexes[TaskSlots[Index]] = Index; // на место удалённой встала последняя задача
+	}
+
+	void CompactRemovedTasks()
+	{
+		if (RemovedTaskCount == 0) return;
+		// с конца, чтобы на место удалённой всегда вставала уже проверенная живая задача
+		for (int32 Index = TaskKeys.Num() - 1; Index >= 0 && RemovedTaskCount != 0; --Index)
+		{
+			if (!(TaskStates[Index] & TaskRemoved)) continue;
+			RemoveTaskAtSwap(Index);
+			--RemovedTaskCount;
+		}
+	}
+
+	FORCEINLINE int32 FindTaskIndex(const FAbilityUpdateHandle Handle) const
+	{
+		return SlotSerials.IsValidIndex(Handle.Slot) && SlotSerials[Handle.Slot] == Handle.Serial ? SlotTaskIndexes[Handle.Slot] : INDEX_NONE;
+	}
+
+	FORCEINLINE FAbilityUpdateHandle MakeTaskHandle(const int32 Index) const
+	{
+		const int32 Slot = TaskSlots[Index];
+		return FAbilityUpdateHandle{ Slot, SlotSerials[Slot] };
+	}
+
+	FORCEINLINE int32 FindTaskIndex(const KeyT& Key) const
+	{
+		const int32* Slot = KeySlots.Find(Key);
+		return Slot ? SlotTaskIndexes[*Slot] : INDEX_NONE;
+	}
+
+	void EndUpdateAt(const int32 Index)
+	{
+		if (Index == INDEX_NONE) return;
+		RemoveTask(Index);
+		TryEndTickerSave();
+	}
+
+	FUpdateAbilityTickerData MakeTaskSnapshot(const int32 Index) const
+	{
+		FUpdateAbilityTickerData Data;
+		Data.UpdateRate = UpdateRates[Index];
+		Data.MaxActiveTime = MaxActiveTimes[Index] != UnlimitedActiveTime ? MaxActiveTimes[Index] : 0.f;
+		Data.UpdateLoopRemainingTime = FMath::Max(LoopElapsed[Index], 0.f);
+		Data.RemainingTime = FMath::Max(ActiveElapsed[Index], 0.f);
+		return Data;
 	}
-	
-	TMap<FName, FUpdateAbilityTickerData> UpdateTasks;
+
+	/** Плотная таблица задач, все столбцы адресуются одним индексом задачи */
+	TArray<KeyT> TaskKeys;
+	TArray<int32> TaskSlots;
+	TArray<float> UpdateRates;
+	TArray<float> MaxActiveTimes;
+	TArray<float> LoopElapsed;
+	TArray<float> ActiveElapsed;
+
+	/** Время модуля на момент последней обработки задачи, задача может пропускать тики при исчерпании бюджета кадра */
+	TArray<double> LastProcessedTimes;
+
+	/** Флаги TaskDue, TaskExpired и TaskRemoved, выставляются проходом по таймерам */
+	TArray<uint8> TaskStates;
+
+	/** Ячейки хендлов: индекс задачи в таблице и номер поколения ячейки */
+	TArray<int32> SlotTaskIndexes;
+	TArray<uint32> SlotSerials;
+	TArray<int32> FreeSlots;
+	TMap<KeyT, int32> KeySlots;
+
+	/** Переиспользуемый буфер индексов готовых задач, отсортирован по индексу */
+	TArray<int32> DueTasks;
+
+	/** Переиспользуемый буфер задач, у которых закончилось MaxActiveTime */
+	TArray<KeyT> ExpiredTasks;
+
+	/** Время модуля, растёт только во время тика */
+	double CurrentTime = 0.0;
+
+	/**
+	 * Задача, с которой начнётся обход готовых задач на следующем тике. Хранится хендлом, так как CompactRemovedTasks
+	 * перекладывает задачи в таблице. Если задачу удалили, обход начнётся с начала.
+	 */
+	FAbilityUpdateHandle ResumeHandle;
+	int32 RemovedTaskCount = 0;
+	bool bIteratingTasks = false;
+
+	/** Время до ближайшего обновления или завершения среди задач, считается во время Tick */
+	float NextUpdateDelay = 0.f;
 public:
-	virtual ~FAbilityUpdateTickerModule() override
+	TAbilityUpdateTickerModule()
+	{
+		TickRateType = ETickerModuleRateType::Deadline;
+	}
+
+	virtual ~TAbilityUpdateTickerModule() override
 	{
-		UpdateTasks.Empty();
+		KeySlots.Empty();
 	}
-	
-	FAbilityUpdateInvoker AbilityUpdateInvoker;	
+
+	FAbilityUpdateInvoker AbilityUpdateInvoker;
 	FDisableAbilityInvoker DisableAbilityInvoker;
 
-	
-	FORCEINLINE void StartAbilityUpdate(const FName& Key, const float UpdateRate, const float MaxActiveTime)
+	/** Запускает обновление по ключу, если его ещё нет. Возвращает хендл задачи или пустой хендл, если ключ уже обновляется */
+	FORCEINLINE FAbilityUpdateHandle StartAbilityUpdate(const KeyT& Key, const float UpdateRate, const float MaxActiveTime)
 	{
-		if (UpdateTasks.Contains(Key)) return;
-		TryStartTicker();
-		UpdateTasks.Add(Key, FUpdateAbilityTickerData(UpdateRate, MaxActiveTime));
+		if (KeySlots.Contains(Key)) return FAbilityUpdateHandle();
+		const FAbilityUpdateHandle Handle = AddTask(Key, UpdateRate, MaxActiveTime);
+		TryStartTicker(); // после вставки, чтобы менеджер видел задачу при заводе тикера
+		return Handle;
 	}
 
-	FORCEINLINE void ReSetAbilityUpdate(const FName& Key, const float UpdateRate, const float MaxActiveTime)
+	FORCEINLINE FAbilityUpdateHandle ReSetAbilityUpdate(const KeyT& Key, const float UpdateRate, const float MaxActiveTime)
 	{
-		if (UpdateTasks.Contains(Key)) EndUpdateAbility(Key);
+		if (const int32 Index = FindTaskIndex(Key); Index != INDEX_NONE) RemoveTask(Index);
+		const FAbilityUpdateHandle Handle = AddTask(Key, UpdateRate, MaxActiveTime);
 		TryStartTicker();
-		UpdateTasks.Add(Key, FUpdateAbilityTickerData(UpdateRate, MaxActiveTime));
+		return Handle;
+	}
+
+	FORCEINLINE void EndUpdateAbility(const KeyT& Key)
+	{
+		EndUpdateAt(FindTaskIndex(Key));
+	}
+
+	FORCEINLINE void EndUpdateAbility(const FAbilityUpdateHandle Handle)
+	{
+		EndUpdateAt(FindTaskIndex(Handle));
+	}
+
+	FORCEINLINE bool IsUpdateRunning(const FAbilityUpdateHandle Handle) const
+	{
+		return FindTaskIndex(Handle) != INDEX_NONE;
+	}
+
+	FORCEINLINE TOptional<FUpdateAbilityTickerData> GetUpdateTask(const KeyT& Key) const
+	{
+		const int32 Index = FindTaskIndex(Key);
+		return Index != INDEX_NONE ? MakeTaskSnapshot(Index) : TOptional<FUpdateAbilityTickerData>();
 	}
-	
-	FORCEINLINE void EndUpdateAbility(const FName& Key)
+
+	FORCEINLINE TOptional<FUpdateAbilityTickerData> GetUpdateTask(const FAbilityUpdateHandle Handle) const
 	{
-		if (!UpdateTasks.Contains(Key)) return;
-		UpdateTasks.Remove(Key);
-		TryEndTickerSave();	
-	}	
-	
-	FORCEINLINE const FUpdateAbilityTickerData* GetUpdateTask(const FName& Key) const
+		const int32 Index = FindTaskIndex(Handle);
+		return Index != INDEX_NONE ? MakeTaskSnapshot(Index) : TOptional<FUpdateAbilityTickerData>();
+	}
+
+	/** Резервирует место под задачи, чтобы добавление задач до этого количества не выделяло память */
+	void ReserveTasks(const int32 TaskCount)
 	{
-		if (!UpdateTasks.Contains(Key)) return nullptr;
-		return &UpdateTasks[Key];
+		TaskKeys.Reserve(TaskCount);
+		TaskSlots.Reserve(TaskCount);
+		UpdateRates.Reserve(TaskCount);
+		MaxActiveTimes.Reserve(TaskCount);
+		LoopElapsed.Reserve(TaskCount);
+		ActiveElapsed.Reserve(TaskCount);
+		LastProcessedTimes.Reserve(TaskCount);
+		TaskStates.Reserve(TaskCount);
+		SlotTaskIndexes.Reserve(TaskCount);
+		SlotSerials.Reserve(TaskCount);
+		FreeSlots.Reserve(TaskCount);
+		KeySlots.Reserve(TaskCount);
+		DueTasks.Reserve(TaskCount);
 	}
-};
\ No newline at end of file
+
+	/** Удаляет все задачи, ключи которых подходят под предикат, без вызова DisableAbilityInvoker */
+	template<typename PredicateT>
+	void RemoveUpdatesIf(PredicateT Predicate)
+	{
+		bool bRemoved = false;
+		for (int32 Index = TaskKeys.Num() - 1; Index >= 0; --Index)
+		{
+			if (TaskStates[Index] & TaskRemoved || !Predicate(TaskKeys[Index])) continue;
+			RemoveTask(Index);
+			bRemoved = true;
+		}
+		if (bRemoved) TryEndTickerSave();
+	}
+};
+
+class DAS_API FAbilityUpdateTickerModule : public TAbilityUpdateTickerModule<FAbilityHandle>
+{
+	GENERATED_TICKER_BODY("AbilityUpdateTickerModule")
+};
@@ -4,62 +4,213 @@
 #include "CoreMinimal.h"
 #include "TickerModule.h"
 #include "Utility/Invoker.h"
+#include "AbilitySystem/AbilityHandle.h"
 
-struct FDelayedTickerFunTask
+template<typename KeyT>
+struct TDelayedTickerFunTask
 {
-	float RemainingTime;
+	TDelayedTickerFunTask(const KeyT& InKey, const double InDeadline, const uint32 InSerial)
+		: Key(InKey)
+		, Deadline(InDeadline)
+		, Serial(InSerial) {}
+
+	KeyT Key;
+
+	/** Абсолютное время модуля, при достижении которого задача будет вызвана */
+	double Deadline;
+
+	/** Порядковый номер задачи, нужен для проверки что ячейка не была переиспользована другой задачей */
+	uint32 Serial;
+
+	/** Индекс ячейки колеса, в списке которой лежит задача */
+	int32 WheelIndex = INDEX_NONE;
+	int32 PrevTask = INDEX_NONE;
+	int32 NextTask = INDEX_NONE;
+
 	TInvoker<void()> Task;
 };
 
 class UDynamicAbility;
 
-class DAS_API FFunHolderTickerModule : public FTickerModule
+/**
+ * Модуль отложенных функций на основе хешированного колеса таймеров.
+ * Задача кладётся в ячейку колеса по своему дедлайну, поэтому тик обходит только ячейки, время которых уже наступило,
+ * а добавление и отмена задачи стоят O(1). Задачи дальше одного оборота колеса лежат в тех же ячейках и просто пропускаются до своего оборота.
+ * Тип ключа задачи задаётся шаблоном, чтобы одно колесо могло обслуживать все системы мира.
+ */
+template<typename KeyT>
+class TFunHolderTickerModule : public FTickerModule
 {
-	GENERATED_TICKER_BODY("FunHolderTickerModule")
+	using FDelayedTickerFunTask = TDelayedTickerFunTask<KeyT>;
+
+	/** Количество ячеек колеса, обязательно степень двойки */
+	static constexpr int32 WheelSize = 512;
+	static constexpr int32 WheelMask = WheelSize - 1;
+
+	/** Количество ячеек на одну секунду, при 128 один оборот колеса занимает 4 секунды */
+	static constexpr double SlotsPerSecond = 128.0;
+
 	virtual void Tick(float DeltaTime) override
 	{
-		TArray<FName> CompletedFunctions;
-		for (auto& FunData : DelayedFunctions)
+		CurrentTime += DeltaTime;
+		const int64 NowSlot = GetSlot(CurrentTime);
+
+		// больше одного оборота за тик обходить не нужно, все ячейки уже будут просмотрены
+		for (int64 Slot = FMath::Max(ProcessedSlot, NowSlot - WheelMask); Slot <= NowSlot; ++Slot)
 		{
-			FunData.Value.RemainingTime -= DeltaTime;
-			if (FunData.Value.RemainingTime <= 0.f)
+			for (int32 Index = WheelHeads[Slot & WheelMask]; Index != INDEX_NONE; Index = Tasks[Index].NextTask)
 			{
-				FunData.Value.Task();
-				CompletedFunctions.Add(FunData.Key);
+				if (Tasks[Index].Deadline <= CurrentTime) DueTasks.Emplace(Index, Tasks[Index].Serial);
 			}
 		}
-		for (auto Key : CompletedFunctions) DelayedFunctions.Remove(Key);
+		ProcessedSlot = NowSlot;
+
+		// вызываем задачи только после обхода колеса, так как задачи могут добавлять и удалять другие задачи
+		for (const auto& [Index, Serial] : DueTasks)
+		{
+			if (!Tasks.IsAllocated(Index) || Tasks[Index].Serial != Serial) continue; // задачу отменили во время вызова предыдущих
+
+			TInvoker<void()> Task = MoveTemp(Tasks[Index].Task);
+			RemoveTask(Index); // удаляем до вызова, чтобы задача могла снова добавить себя по тому же ключу
+			Task();
+		}
+		DueTasks.Reset();
 	}
 	virtual bool NeedUpdate() const override
 	{
-		return !DelayedFunctions.IsEmpty();
+		return Tasks.Num() != 0;
+	}
+	virtual int32 GetActiveTaskCount() const override
+	{
+		return Tasks.Num();
+	}
+	virtual double GetNextUpdateDelay() const override
+	{
+		// ищем ближайшую занятую ячейку колеса, начиная с текущей
+		int64 Slot = ProcessedSlot;
+		for (const int64 EndSlot = ProcessedSlot + WheelSize; Slot < EndSlot;)
+		{
+			const int32 WheelIndex = static_cast<int32>(Slot & WheelMask);
+			if (const uint64 Word = OccupiedSlots[WheelIndex >> 6] >> (WheelIndex & 63))
+			{
+				Slot += FMath::CountTrailingZeros64(Word);
+				break;
+			}
+			Slot += 64 - (WheelIndex & 63);
+		}
+
+		// в ячейке могут лежать задачи следующих оборотов, поэтому просыпаемся не позже конца ячейки
+		double Deadline = static_cast<double>(Slot + 1) / SlotsPerSecond;
+		for (int32 Index = WheelHeads[Slot & WheelMask]; Index != INDEX_NONE; Index = Tasks[Index].NextTask)
+		{
+			Deadline = FMath::Min(Deadline, Tasks[Index].Deadline);
+		}
+		return FMath::Max(Deadline - CurrentTime, 0.0);
+	}
+
+	FORCEINLINE static int64 GetSlot(const double Time)
+	{
+		return FMath::FloorToInt64(Time * SlotsPerSecond);
+	}
+
+	void LinkTask(const int32 Index)
+	{
+		FDelayedTickerFunTask& FunTask = Tasks[Index];
+		FunTask.WheelIndex = static_cast<int32>(FMath::Max(GetSlot(FunTask.Deadline), ProcessedSlot) & WheelMask);
+		FunTask.PrevTask = INDEX_NONE;
+		FunTask.NextTask = WheelHeads[FunTask.WheelIndex];
+
+		if (FunTask.NextTask != INDEX_NONE) Tasks[FunTask.NextTask].PrevTask = Index;
+		WheelHeads[FunTask.WheelIndex] = Index;
+		OccupiedSlots[FunTask.WheelIndex >> 6] |= 1ull << (FunTask.WheelIndex & 63);
+	}
+
+	void RemoveTask(const int32 Index)
+	{
+		const FDelayedTickerFunTask& FunTask = Tasks[Index];
+		if (FunTask.PrevTask != INDEX_NONE) Tasks[FunTask.PrevTask].NextTask = FunTask.NextTask;
+		else WheelHeads[FunTask.WheelIndex] = FunTask.NextTask;
+		if (FunTask.NextTask != INDEX_NONE) Tasks[FunTask.NextTask].PrevTask = FunTask.PrevTask;
+		if (WheelHeads[FunTask.WheelIndex] == INDEX_NONE) OccupiedSlots[FunTask.WheelIndex >> 6] &= ~(1ull << (FunTask.WheelIndex & 63));
+
+		TaskIndexes.Remove(FunTask.Key);
+		Tasks.RemoveAt(Index);
 	}
 
-	TMap<FName, FDelayedTickerFunTask> DelayedFunctions;
+	/** Время модуля, растёт только во время тика, поэтому на паузе дедлайны не сгорают */
+	double CurrentTime = 0.0;
+
+	/** Последняя ячейка, до которой колесо уже было обойдено */
+	int64 ProcessedSlot = 0;
+	uint32 NextSerial = 0;
+
+	/** Голова списка задач для каждой ячейки колеса */
+	int32 WheelHeads[WheelSize];
+
+	/** Битовая маска непустых ячеек колеса, по ней быстро ищется ближайший дедлайн */
+	uint64 OccupiedSlots[WheelSize / 64] = {};
+
+	TSparseArray<FDelayedTickerFunTask> Tasks;
+	TMap<KeyT, int32> TaskIndexes;
+
+	/** Переиспользуемый буфер задач готовых к вызову, чтобы тик не выделял память */
+	TArray<TPair<int32, uint32>> DueTasks;
 public:
-	FFunHolderTickerModule() = default;
-	
-	FFunHolderTickerModule(const FFunHolderTickerModule&) = delete;
-	FFunHolderTickerModule& operator=(const FFunHolderTickerModule&) = delete;
-	
-	FFunHolderTickerModule(FFunHolderTickerModule&&) noexcept = default;
-	FFunHolderTickerModule& operator=(FFunHolderTickerModule&&) noexcept = default;
-	
-	virtual ~FFunHolderTickerModule() override
+	TFunHolderTickerModule()
+	{
+		TickRateType = ETickerModuleRateType::Deadline;
+		for (int32& Head : WheelHeads) Head = INDEX_NONE;
+	}
+
+	TFunHolderTickerModule(const TFunHolderTickerModule&) = delete;
+	TFunHolderTickerModule& operator=(const TFunHolderTickerModule&) = delete;
+
+	TFunHolderTickerModule(TFunHolderTickerModule&&) noexcept = default;
+	TFunHolderTickerModule& operator=(TFunHolderTickerModule&&) noexcept = default;
+
+	virtual ~TFunHolderTickerModule() override
 	{
-		DelayedFunctions.Empty();
+		Tasks.Empty();
+		TaskIndexes.Empty();
 	}
-	
-	TInvoker<void()>* AddDelayedFun(const FName& Key, const float DelaySeconds)
-	{	
-		if (DelayedFunctions.Contains(Key)) return nullptr;
-		TryStartTicker();
-		return &DelayedFunctions.Add(Key, FDelayedTickerFunTask(DelaySeconds)).Task;
+
+	TInvoker<void()>* AddDelayedFun(const KeyT& Key, const float DelaySeconds)
+	{
+		int32& FoundIndex = TaskIndexes.FindOrAdd(Key, INDEX_NONE);
+		if (FoundIndex != INDEX_NONE) return nullptr;
+
+		// модуль мог проспать до дальнего дедлайна, задержка считается от настоящего времени, а не от последнего тика
+		FoundIndex = Tasks.Emplace(Key, CurrentTime + GetTimeSinceLastTick() + DelaySeconds, NextSerial++);
+
+		const int32 Index = FoundIndex;
+		LinkTask(Index);
+		TryStartTicker(); // после вставки, иначе менеджер посчитает модуль пустым и заведёт тикер не по дедлайну задачи
+		return &Tasks[Index].Task;
 	}
-	FORCEINLINE void RemoveDelayedFun(const FName& Key)
+	FORCEINLINE void RemoveDelayedFun(const KeyT& Key)
 	{
-		if (!DelayedFunctions.Contains(Key)) return;
-		DelayedFunctions.Remove(Key);
+		const int32* Index = TaskIndexes.Find(Key);
+		if (!Index) return;
+		RemoveTask(*Index);
 		TryEndTickerSave();
 	}
-};
\ No newline at end of file
+
+	/** Удаляет все отложенные функции, ключи которых подходят под предикат */
+	template<typename PredicateT>
+	void RemoveDelayedFunsIf(PredicateT Predicate)
+	{
+		bool bRemoved = false;
+		for (auto It = Tasks.CreateIterator(); It; ++It)
+		{
+			if (!Predicate(It->Key)) continue;
+			RemoveTask(It.GetIndex());
+			bRemoved = true;
+		}
+		if (bRemoved) TryEndTickerSave();
+	}
+};
+
+class DAS_API FFunHolderTickerModule : public TFunHolderTickerModule<FAbilityHandle>
+{
+	GENERATED_TICKER_BODY("FunHolderTickerModule")
+};
@@ -0,0 +1,40 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AbilityUpdateTickerModule.h"
+#include "FunHolderTickerModule.h"
+
+class UDynamicAbilitySystem;
+
+/** Ключ задачи в общих модулях мира: система-владелец и хендл способности внутри неё */
+struct FAbilityTickerKey
+{
+	FAbilityTickerKey(UDynamicAbilitySystem* InSystem, const FAbilityHandle& InHandle)
+		: System(InSystem)
+		, Handle(InHandle) {}
+
+	UDynamicAbilitySystem* System;
+	FAbilityHandle Handle;
+
+	FORCEINLINE bool operator==(const FAbilityTickerKey& Other) const
+	{
+		return System == Other.System && Handle == Other.Handle;
+	}
+	FORCEINLINE friend uint32 GetTypeHash(const FAbilityTickerKey& TickerKey)
+	{
+		return HashCombineFast(PointerHash(TickerKey.System), GetTypeHash(TickerKey.Handle));
+	}
+};
+
+/** Общий для всех систем мира модуль обновления способностей */
+class DAS_API FSharedAbilityUpdateTickerModule : public TAbilityUpdateTickerModule<FAbilityTickerKey>
+{
+	GENERATED_TICKER_BODY("SharedAbilityUpdateTickerModule")
+};
+
+/** Общий для всех систем мира модуль отложенных функций */
+class DAS_API FSharedFunHolderTickerModule : public TFunHolderTickerModule<FAbilityTickerKey>
+{
+	GENERATED_TICKER_BODY("SharedFunHolderTickerModule")
+};
@@ -145,13 +145,13 @@ template <typename T, typename AbilityT>
 void FAbilityInfoWindowModule<T, AbilityT>::UpdateAbilitiesInfo() const
 {
 	AbilitiesInfoBox->ClearChildren();
-	if (!AbilitySystem->GetAbilities().IsEmpty())
+	if (AbilitySystem->GetAbilityCount() != 0)
 	{
-		for (const auto& AbilityData : AbilitySystem->GetAbilities())
+		AbilitySystem->ForEachAbility([this](const FName& Key, UDynamicAbility* Ability)
 		{
-			if constexpr (std::is_same_v<AbilityT, UDynamicAbility>) UpdateAbilityInfo(AbilityData.Key, AbilityData.Value.Get());
-			else UpdateAbilityInfo(AbilityData.Key, CastChecked<AbilityT>(AbilityData.Value.Get()));
-		}
+			if constexpr (std::is_same_v<AbilityT, UDynamicAbility>) UpdateAbilityInfo(Key, Ability);
+			else UpdateAbilityInfo(Key, CastChecked<AbilityT>(Ability));
+		});
 	}
 	else
 	{
@@ -168,7 +168,8 @@ void FAbilityInfoWindowModule<T, AbilityT>::UpdateAbilityInfo(const FName& Key,
 {
 	TSharedPtr<SVerticalBox> LeftAbilityBox;
 	TSharedPtr<SVerticalBox> RightAbilityBox;
-	const auto& CurrentAbilitySettings =  UDynamicAbilitySystem::FindSlideData(Ability, ESlideSettingsType::Current, true);
+	const auto* CurrentAbilitySettings = &UDynamicAbilitySystem::GetCurrentSlideData(Ability);
+	const FAbilitySlideTimings CurrentTimings = UDynamicAbilitySystem::GetSlideTimings(Ability, Ability->CurrentSlideId);
 	
 	// Base Data:
 	AbilitiesInfoBox->AddSlot()
@@ -194,19 +195,19 @@ void FAbilityInfoWindowModule<T, AbilityT>::UpdateAbilityInfo(const FName& Key,
 				.AutoHeight()
 				[
 					SNew(STextBlock)
-					.Text(FText::FromString(FString::Printf(TEXT("Max active time: %.2f"), CurrentAbilitySettings->MaxActiveTime)))
+					.Text(FText::FromString(FString::Printf(TEXT("Max active time: %.2f"), CurrentTimings.MaxActiveTime)))
 				]
 				+ SVerticalBox::Slot() // это должна быть доп инфа
 				.AutoHeight()
 				[
 					SNew(STextBlock)
-					.Text(FText::FromString(FString::Printf(TEXT("Logic delay: %.2f"), CurrentAbilitySettings->ActivationDelay)))
+					.Text(FText::FromString(FString::Printf(TEXT("Logic delay: %.2f"), CurrentTimings.ActivationDelay)))
 				]
 				+ SVerticalBox::Slot() // это должна быть доп инфа
 				.AutoHeight()
 				[
 					SNew(STextBlock)
-					.Text(FText::FromString(FString::Printf(TEXT("Update rate: %.2f"), CurrentAbilitySettings->UpdateAbilityRate)))
+					.Text(FText::FromString(FString::Printf(TEXT("Update rate: %.2f"), CurrentTimings.UpdateAbilityRate)))
 				]
 			]
 			+ SHorizontalBox::Slot()
@@ -224,7 +225,7 @@ void FAbilityInfoWindowModule<T, AbilityT>::UpdateAbilityInfo(const FName& Key,
 				.AutoHeight()
 				[
 					SNew(STextBlock)
-					.Text(FText::FromString(FString::Printf(TEXT("Slide: %s"), *Ability->CurrentSlideType.ToString())))
+					.Text(FText::FromString(FString::Printf(TEXT("Slide: %s"), *Ability->GetCurrentSlideTag().ToString())))
 				]
 				+ SVerticalBox::Slot()
 				.AutoHeight()	
@@ -237,11 +238,10 @@ void FAbilityInfoWindowModule<T, AbilityT>::UpdateAbilityInfo(const FName& Key,
 	];
 
 	// Additional Data:
-	if (Ability->AbilityFlags.Contains(EAbilityFlag::Updating) && CurrentAbilitySettings->MaxActiveTime != 0.f)  // AbilityRemainingTime
+	if (Ability->AbilityFlags.Contains(EAbilityFlag::Updating) && CurrentTimings.MaxActiveTime != 0.f)  // AbilityRemainingTime
 	{
-		const auto* UpdateModule = AbilitySystem->template GetTickerModule<FAbilityUpdateTickerModule>();
-		const FUpdateAbilityTickerData* Task = UpdateModule ? UpdateModule->GetUpdateTask(Key) : nullptr;
-		check(Task)
+		const TOptional<FUpdateAbilityTickerData> Task = AbilitySystem->GetAbilityUpdateTask(Ability->AbilityHandle);
+		check(Task.IsSet())
 		LeftAbilityBox->AddSlot()
 		.AutoHeight()
 		[
@@ -2,6 +2,7 @@
 #include "MovementAbilitySystem/MovementAbilitySystem.h"
 #include "MovementSystemComponent.h"
 #include "MovementAbility/MovementAbility.h"
+#include "AbilitySystem/AbilitySettingsRegistry.h"
 
 DEFINE_LOG_CATEGORY(LogMovementAbilitySystem);
 
@@ -9,6 +10,18 @@ UMovementAbilitySystem::UMovementAbilitySystem()
 {
 	MovementSystemComponent = CreateDefaultSubobject<UMovementSystemComponent>("MovementComponent");
 	MovementSystemComponent->ApplyMovementEdits.Bind(this, &UMovementAbilitySystem::ApplyDelayedMovementEdits);
+
+	// правки движения от способностей применяются компонентом в том же кадре
+	bTickInPrePhysics = true;
+}
+
+void UMovementAbilitySystem::BeginPlay()
+{
+	Super::BeginPlay();
+	if (!AddAbilityTickPrerequisite(MovementSystemComponent->PrimaryComponentTick))
+	{
+		UE_LOG(LogMovementAbilitySystem, Log, TEXT("Abilities are ticked outside the world tick, movement edits will be applied one frame later."));
+	}
 }
 
 void UMovementAbilitySystem::OnAbilityAdded(const FName Key, UDynamicAbility* Ability, const UObject* Adder)
@@ -42,7 +55,11 @@ bool UMovementAbilitySystem::FindAndSetAbilitySettings(const FName& Key, UDynami
 	{
 		if (UMovementAbility* MovementAbility = CastChecked<UMovementAbility>(Ability))
 		{
-			MovementAbility->MovementAbilitySettings = *MovementAbilitiesSettings->FindRow<FMovementAbilitySettings>(Key, TEXT("Cannot find settings for movement ability"));
+			const auto* Settings = MovementAbilitiesSettings->FindRow<FMovementAbilitySettings>(Key, TEXT("Cannot find settings for movement ability"));
+			MovementAbility->SharedMovementSettings = FAbilitySettingsRegistry::FindOrCreate<FMovementAbilitySettings>(MovementAbilitiesSettings, Key, [Settings]
+			{
+				return MakeShared<const FMovementAbilitySettings>(*Settings);
+			});
 			return true;
 		}
 	}
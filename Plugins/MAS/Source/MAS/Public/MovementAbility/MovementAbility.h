@@ -32,9 +32,30 @@ protected:
 	FORCEINLINE const UMovementSystemComponent* GetMovementSystem() const { return MovementSystem.Get(); }
 	FORCEINLINE const UMovementAbilitySystem* GetMovementAbilitySystem() const { return MovementAbilitySystem.Get(); }
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MovementSettings")
+	/**
+	 * Настройки движения по умолчанию. Если настройки ищутся в таблице, система их не читает, поэтому поле только для чтения,
+	 * а действующие настройки отдаёт GetMovementAbilitySettings
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "MovementSettings")
 	FMovementAbilitySettings MovementAbilitySettings;
 
+	/** Строка MovementAbilitiesSettings, общая для всех экземпляров, если настройки ищутся в таблице */
+	TSharedPtr<const FMovementAbilitySettings> SharedMovementSettings;
+
+	/** Действующие настройки движения: строка таблицы, если она найдена, иначе настройки класса */
+	FORCEINLINE const FMovementAbilitySettings& GetMovementAbilitySettings() const
+	{
+		return SharedMovementSettings ? *SharedMovementSettings : MovementAbilitySettings;
+	}
+
+	virtual void ResetAbility() override
+	{
+		Super::ResetAbility();
+		MovementSystem = nullptr;
+		MovementAbilitySystem = nullptr;
+		SharedMovementSettings.Reset();
+	}
+
 	FORCEINLINE UMovementSystemComponent* GetMutableMovementSystem() const;
 	FORCEINLINE UMovementAbilitySystem* GetMutableMovementAbilitySystem() const;
 
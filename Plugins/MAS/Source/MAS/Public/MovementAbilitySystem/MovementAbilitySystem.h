@@ -44,6 +44,8 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "SecuritySettings")
 	TMap<TSubclassOf<UMovementAbility>, FMovementTypeContainer> AbilitiesMovementSettingsAllows;
 
+	virtual void BeginPlay() override;
+
 	virtual bool ValidateAbilityAddition(const FName Key, const TSubclassOf<UDynamicAbility>& AbilityClass, const UObject* Adder) const override;
 	virtual bool FindAndSetAbilitySettings(const FName& Key, UDynamicAbility* Ability) const override;
 
@@ -24,7 +24,7 @@ protected:
 		{
 			for (const auto Allow : AllowsSettings->Types)
 			{
-				if (const auto Priority = Ability->MovementAbilitySettings.PrioritySettings.Find(Allow))
+				if (const auto Priority = Ability->GetMovementAbilitySettings().PrioritySettings.Find(Allow))
 				{
 					auto Text = FString::Printf(TEXT("%s, %d"),
 						*StaticEnum<EMovementSettingsType>()->GetDisplayNameTextByValue(Allow).ToString(), *Priority);
@@ -0,0 +1,64 @@
+﻿
+#include "AsyncTickerModule.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+FAsyncTickerModule::FAsyncTickerModule()
+{
+	// Tick модуля только запускает задачу и меняет буферы, параллелить его с другими модулями незачем
+	bThreadSafeTick = false;
+}
+
+FAsyncTickerModule::~FAsyncTickerModule()
+{
+	WaitForAsyncTick();
+}
+
+void FAsyncTickerModule::Tick(const float DeltaTime)
+{
+	PendingAsyncDeltaTime += DeltaTime;
+	if (bAsyncTickInFlight)
+	{
+		if (!AsyncTickTask.IsCompleted()) // не ждём воркер, забираем результат на следующем тике
+		{
+			RequestNextSlice();
+			return;
+		}
+		bAsyncTickInFlight = false;
+		SwapAsyncResults();
+		if (bCollectTick)
+		{
+			bCollectTick = false;
+			return;
+		}
+	}
+
+	if (!NeedAsyncUpdate())
+	{
+		PendingAsyncDeltaTime = 0.f;
+		return;
+	}
+
+	const float AsyncDeltaTime = PendingAsyncDeltaTime;
+	PendingAsyncDeltaTime = 0.f;
+	GatherAsyncInput(AsyncDeltaTime);
+
+	bAsyncTickInFlight = true;
+	AsyncTickTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, AsyncDeltaTime]
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(FAsyncTickerModule::TickAsync);
+		TickAsync(AsyncDeltaTime);
+	}, AsyncTaskPriority);
+
+	// модули со своим расписанием иначе забрали бы результат только к следующему плановому тику
+	if (TickRateType != ETickerModuleRateType::EveryFrame)
+	{
+		bCollectTick = true;
+		RequestNextSlice();
+	}
+}
+
+void FAsyncTickerModule::WaitForAsyncTick()
+{
+	if (!bAsyncTickInFlight) return;
+	AsyncTickTask.Wait();
+}
@@ -0,0 +1,103 @@
+﻿
+#include "CoroutineTickerModule.h"
+
+FCoroutineTickerModule::FCoroutineTickerModule()
+{
+	TickRateType = ETickerModuleRateType::Deadline;
+}
+
+FCoroutineTickerModule::~FCoroutineTickerModule()
+{
+	for (FTaskSlot& Slot : Tasks) Slot.Coroutine.destroy();
+	Tasks.Empty();
+	FTickerTaskFramePool::Trim();
+}
+
+void FCoroutineTickerModule::Tick(float DeltaTime)
+{
+	CurrentTime += DeltaTime;
+
+	// корутины, запланированные во время обработки, попадут уже в новый NextTickTasks и выполнятся на следующем тике
+	Swap(ResumingTasks, NextTickTasks);
+	while (!DeadlineTasks.IsEmpty() && DeadlineTasks.HeapTop().WakeTime <= CurrentTime)
+	{
+		FTaskDeadline Deadline;
+		DeadlineTasks.HeapPop(Deadline, EAllowShrinking::No);
+		ResumingTasks.Add(Deadline.Handle);
+	}
+
+	for (const FTickerTaskHandle& Handle : ResumingTasks) ResumeTask(Handle);
+	ResumingTasks.Reset();
+}
+
+bool FCoroutineTickerModule::NeedUpdate() const
+{
+	return !NextTickTasks.IsEmpty() || !DeadlineTasks.IsEmpty();
+}
+
+double FCoroutineTickerModule::GetNextUpdateDelay() const
+{
+	if (!NextTickTasks.IsEmpty() || DeadlineTasks.IsEmpty()) return 0.0;
+	return FMath::Max(DeadlineTasks.HeapTop().WakeTime - CurrentTime, 0.0);
+}
+
+void FCoroutineTickerModule::ResumeTask(const FTickerTaskHandle& Handle)
+{
+	if (!IsHandleAlive(Handle)) return; // корутину отменили, пока она ждала
+	const FTickerTask::FHandle Coroutine = Tasks[Handle.Index].Coroutine;
+	Tasks[Handle.Index].bExecuting = true;
+	Coroutine.resume();
+
+	// корутина могла отменить себя (например, выключив свою способность), тогда Cancel только пометил её
+	FTaskSlot& Slot = Tasks[Handle.Index];
+	Slot.bExecuting = false;
+	if (Slot.bCancelled || Coroutine.done()) DestroyTask(Handle.Index);
+}
+
+void FCoroutineTickerModule::DestroyTask(const int32 Index)
+{
+	const FTickerTask::FHandle Coroutine = Tasks[Index].Coroutine;
+	Tasks.RemoveAt(Index);
+	Coroutine.destroy();
+	TryEndTickerSave();
+}
+
+FTickerTaskHandle FCoroutineTickerModule::Launch(FTickerTask&& Task)
+{
+	check(Task.IsValid())
+	const FTickerTask::FHandle Coroutine = Task.Release();
+
+	FTickerTaskHandle Handle;
+	Handle.Serial = NextSerial++;
+	Handle.Index = Tasks.Emplace(FTaskSlot{ Coroutine, Handle.Serial });
+
+	auto& Promise = Coroutine.promise();
+	Promise.Module = this;
+	Promise.Handle = Handle;
+
+	ResumeTask(Handle);
+	return IsHandleAlive(Handle) ? Handle : FTickerTaskHandle();
+}
+
+void FCoroutineTickerModule::Cancel(const FTickerTaskHandle& Handle)
+{
+	if (!IsHandleAlive(Handle)) return;
+	FTaskSlot& Slot = Tasks[Handle.Index];
+	if (Slot.bExecuting) Slot.bCancelled = true; // нельзя уничтожать кадр, пока resume корутины ещё на стеке
+	else DestroyTask(Handle.Index);
+}
+
+void FCoroutineTickerModule::Resume(const FTickerTaskHandle& Handle)
+{
+	if (!IsHandleAlive(Handle)) return;
+	NextTickTasks.Add(Handle);
+	TryStartTicker(); // после вставки, чтобы менеджер видел работу модуля
+}
+
+void FCoroutineTickerModule::ResumeAfter(const FTickerTaskHandle& Handle, const float Seconds)
+{
+	if (!IsHandleAlive(Handle)) return;
+	// модуль мог проспать до дальнего дедлайна, ожидание считается от настоящего времени, а не от последнего тика
+	DeadlineTasks.HeapPush({ CurrentTime + GetTimeSinceLastTick() + Seconds, Handle });
+	TryStartTicker();
+}
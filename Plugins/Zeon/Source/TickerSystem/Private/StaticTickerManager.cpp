@@ -1,68 +1,294 @@
 ﻿
 #include "StaticTickerManager.h"
 #include "UObject/UObjectGlobals.h"
+#include "Misc/App.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include "Algo/BinarySearch.h"
 #include "Utility/PauseManager.h"
 #include "Utility/ZeonUtilits.h"
 #include "TickerModule.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "TickerWorldSubsystem.h"
 
 DEFINE_LOG_CATEGORY(LogStaticTicker);
 
+/** Задержка тикера, когда все занятые модули стоят на паузе, после снятия паузы тикер перевзводится сразу */
+static constexpr float SleepingTickerDelay = 1.f;
+
 FStaticTickerManager::FStaticTickerManager()
+	: LifetimeToken(MakeShared<FStaticTickerManager*, ESPMode::ThreadSafe>(this))
 {
-	GameStartedDelegateHandle = FZeonUtil::OnWorldBeginPlay.AddRaw(this, &FStaticTickerManager::OnGameStarted);
-	GameEndedDelegateHandle = FWorldDelegates::OnWorldBeginTearDown.AddRaw(this, &FStaticTickerManager::OnGameEnded);
-	GamePauseDelegateHandle = FPauseManager::OnGamePause.AddRaw(this, &FStaticTickerManager::OnGamePaused);
 	TryAutoModifyTickerState(ETickerStateType::Init);
 }
 
 FStaticTickerManager::~FStaticTickerManager()
 {
-	EndTicker();
-	FZeonUtil::OnWorldBeginPlay.Remove(GameStartedDelegateHandle);
-	FWorldDelegates::OnWorldBeginTearDown.Remove(GameEndedDelegateHandle);
-	FPauseManager::OnGamePause.Remove(GamePauseDelegateHandle);
+	*LifetimeToken = nullptr;
+	if (TickHandle.IsValid()) EndTicker();
+	UnsubscribeFromGameEvents();
+	for (FStaticTickerTickFunction& TickFunction : PhaseTickFunctions) TickFunction.UnRegisterTickFunction();
+	ModulesByTypeId.Empty();
+	for (auto& PhaseWaves : TickWaves) PhaseWaves.Empty();
 	TickerModules.Empty();
 }
 
+void FStaticTickerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager) Manager->TickPhase(Phase);
+}
+
+FString FStaticTickerTickFunction::DiagnosticMessage()
+{
+	return Manager ? FString::Printf(TEXT("%s[Phase %d]"), *Manager->TickerDebugName, static_cast<int32>(Phase)) : TEXT("StaticTickerManager[Unbound]");
+}
+
 bool FStaticTickerManager::Tick(float DeltaTime)
 {
-	for (auto& [_, Module] : TickerModules)
+	TICKER_SCOPE_MANAGER(*TickerDebugName);
+	if (bTickWavesDirty) BuildTickWaves();
+	FrameBudgetEndTime = FrameBudgetMicroseconds > 0.f ? FPlatformTime::Seconds() + FrameBudgetMicroseconds * 1e-6 : TNumericLimits<double>::Max();
+
+	bIsTicking = true;
+	if (HasPendingCommands()) ExecutePendingCommands();
+	if (!bUseFixedTimeStep)
+	{
+		TickerTime = GetSourceTime();
+		TickModules();
+	}
+	else
 	{
-		if (Module->bTickInPauseDisabled && bLastPauseState) continue;
-		Module->Tick(DeltaTime);
+		const double RealTime = GetSourceTime();
+		FixedStepAccumulator += RealTime - FixedStepRealTime;
+		FixedStepRealTime = RealTime;
+
+		int32 SubSteps = 0;
+		for (; FixedStepAccumulator >= FixedTimeStep && SubSteps < MaxSubSteps; ++SubSteps)
+		{
+			FixedStepAccumulator -= FixedTimeStep;
+			TickerTime += FixedTimeStep;
+			TickModules();
+		}
+		// после фриза не догоняем всё время, иначе каждый следующий кадр будет ещё дольше
+		if (FixedStepAccumulator >= FixedTimeStep) FixedStepAccumulator = FMath::Fmod(FixedStepAccumulator, static_cast<double>(FixedTimeStep));
+		InterpolationAlpha = static_cast<float>(FixedStepAccumulator / FixedTimeStep);
 	}
-	return !CleanupManager(DeltaTime);
+	bIsTicking = false;
+	FrameBudgetEndTime = TNumericLimits<double>::Max();
+
+	if (bEndRequested)
+	{
+		bEndRequested = false;
+		TickHandle.Reset();
+		return false;
+	}
+	return ArmTicker(true);
+}
+
+void FStaticTickerManager::TickImmediately()
+{
+	check(IsInGameThread())
+	check(!bIsTicking)
+	const FTSTicker::FDelegateHandle PreviousHandle = TickHandle;
+
+	// false означает, что делегат заменён или тикер остановлен, а вызов шёл не из FTSTicker, поэтому старый делегат снимаем сами
+	if (!Tick(0.f) && PreviousHandle.IsValid()) FTSTicker::GetCoreTicker().RemoveTicker(PreviousHandle);
 }
 
-bool FStaticTickerManager::CleanupManager(float DeltaTime)
+void FStaticTickerManager::TickPhase(const ETickerPhase Phase)
 {
-	if (!TickHandle.IsValid() || !bUseCleanupSystem) return false;
-	
-	CurrentCleanupTime += DeltaTime;
-	if (CleanupRate <= CurrentCleanupTime)
+	TICKER_SCOPE_MANAGER(*TickerDebugName);
+	if (bTickWavesDirty) BuildTickWaves();
+	if (HasPendingCommands()) ExecutePendingCommands();
+	FrameBudgetEndTime = FrameBudgetMicroseconds > 0.f ? FPlatformTime::Seconds() + FrameBudgetMicroseconds * 1e-6 : TNumericLimits<double>::Max();
+
+	// фазы мира идут по реальному времени кадра, фиксированный шаг относится только к главному тикеру
+	const double Time = GetSourceTime();
+	for (const auto& Wave : TickWaves[static_cast<int32>(Phase)]) TickWave(Wave, Time);
+	FrameBudgetEndTime = TNumericLimits<double>::Max();
+}
+
+void FStaticTickerManager::EnqueueCommand(TInvoker<void()>&& Command)
+{
+	PendingCommands.Enqueue(MoveTemp(Command));
+	if (bCommandsWakeScheduled.exchange(true)) return; // задача уже поставлена и ещё не выполнилась
+
+	// состояние тикера читается только на игровом потоке, поэтому задача ставится всегда, а не только при остановленном тикере
+
+	AsyncTask(ENamedThreads::GameThread, [WeakToken = TWeakPtr<FStaticTickerManager*, ESPMode::ThreadSafe>(LifetimeToken)]
+	{
+		const auto Token = WeakToken.Pin();
+		if (!Token || !*Token) return;
+		if (FStaticTickerManager* Manager = *Token; !Manager->bIsTicking) Manager->ExecutePendingCommands();
+	});
+}
+
+void FStaticTickerManager::ExecutePendingCommands()
+{
+	check(IsInGameThread())
+	bCommandsWakeScheduled = false; // команды, поставленные во время выполнения, поставят новую задачу
+
+	TInvoker<void()> Command;
+	while (PendingCommands.Dequeue(Command)) Command();
+}
+
+void FStaticTickerManager::TickModules()
+{
+	for (int32 Phase = 0; Phase < TickerPhaseCount; ++Phase)
 	{
-		CurrentCleanupTime = 0.f;
-		if (!DoesRequireTicker(nullptr))
+		if (IsPhaseBound(static_cast<ETickerPhase>(Phase))) continue;
+		for (const auto& Wave : TickWaves[Phase]) TickWave(Wave, TickerTime);
+	}
+}
+
+void FStaticTickerManager::TickWave(const TArray<FTickerModule*>& Wave, const double Time)
+{
+	DueGameThreadModules.Reset();
+	DueThreadSafeModules.Reset();
+	for (FTickerModule* Module : Wave)
+	{
+		if (Module->bTickInPauseDisabled && bLastPauseState)
 		{
-			UE_LOG(LogStaticTicker, Error, TEXT("Ticker leak: running without active tasks, forcibly stopped."));
-			return true;
+			Module->LastTickTime = Time; // время паузы модулю не засчитывается
+			continue;
 		}
+		if (Module->NextTickTime > Time) continue;
+
+		Module->PendingDeltaTime = static_cast<float>(Time - Module->LastTickTime);
+		Module->LastTickTime = Time;
+		Module->bWakeRequested = false;
+		(Module->bThreadSafeTick ? DueThreadSafeModules : DueGameThreadModules).Add(Module);
+	}
+
+	for (FTickerModule* Module : DueGameThreadModules)
+	{
+		TICKER_SCOPE_MODULE(Module->Instrumentation);
+		Module->Tick(Module->PendingDeltaTime);
+	}
+
+	// один модуль нет смысла отдавать в task graph, ParallelFor в этом случае всё равно выполнит его на текущем потоке
+	ParallelFor(DueThreadSafeModules.Num(), [this](const int32 Index)
+	{
+		FTickerModule* Module = DueThreadSafeModules[Index];
+		TICKER_SCOPE_MODULE(Module->Instrumentation);
+		Module->Tick(Module->PendingDeltaTime);
+	}, DueThreadSafeModules.Num() < 2 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	// планирование трогает состояние менеджера, поэтому только после join и только на игровом потоке
+	for (FTickerModule* Module : DueGameThreadModules)
+	{
+		RefreshModuleActivity(*Module);
+		ScheduleModule(*Module);
+		TICKER_SET_TASK_COUNT(Module->Instrumentation, Module->GetActiveTaskCount());
+	}
+	for (FTickerModule* Module : DueThreadSafeModules)
+	{
+		RefreshModuleActivity(*Module);
+		ScheduleModule(*Module);
+		TICKER_SET_TASK_COUNT(Module->Instrumentation, Module->GetActiveTaskCount());
 	}
-	return false;
 }
 
-bool FStaticTickerManager::DoesRequireTicker(const FTickerModule* IgnoreModule) const
+void FStaticTickerManager::BuildTickWaves()
 {
-	if (TickerModules.IsEmpty()) return false;
-	for (auto& ModuleData : TickerModules)
+	bTickWavesDirty = false;
+	for (auto& PhaseWaves : TickWaves) PhaseWaves.Reset();
+
+	// счётчики и списки зависимых модулей адресуются номером типа модуля
+	TArray<int32> PendingPrerequisites;
+	TArray<TArray<FTickerModule*>> Dependents;
+	PendingPrerequisites.SetNumZeroed(ModulesByTypeId.Num());
+	Dependents.SetNum(ModulesByTypeId.Num());
+
+	TArray<FTickerModule*> PhaseReady[TickerPhaseCount];
+	for (const auto& Module : TickerModules)
 	{
-		if (const auto Module = ModuleData.Value.Get(); Module->NeedUpdate())
+		for (const FName& Prerequisite : Module->TickPrerequisites)
 		{
-			if (!IgnoreModule) return true;
-			if (ModuleData.Key != IgnoreModule->ModuleName) return true;
+			const FTickerModule* PrerequisiteModule = FindModuleByTypeId(FTickerModuleTypeRegistry::FindTypeId(Prerequisite));
+			if (PrerequisiteModule == Module.Get()) continue;
+			if (!PrerequisiteModule)
+			{
+				UE_LOG(LogStaticTicker, Warning, TEXT("Module '%s' depends on unknown module '%s'"), *Module->ModuleName.ToString(), *Prerequisite.ToString());
+				continue;
+			}
+			if (PrerequisiteModule->TickPhase != Module->TickPhase) // порядок фаз задаётся группами тика, раньше идущая фаза и так обновится раньше
+			{
+				if (PrerequisiteModule->TickPhase > Module->TickPhase)
+				{
+					UE_LOG(LogStaticTicker, Warning, TEXT("Module '%s' depends on module '%s' from a later tick phase, the prerequisite is ignored"), *Module->ModuleName.ToString(), *Prerequisite.ToString());
+				}
+				continue;
+			}
+			Dependents[PrerequisiteModule->ModuleTypeId].Add(Module.Get());
+			++PendingPrerequisites[Module->ModuleTypeId];
 		}
+		if (PendingPrerequisites[Module->ModuleTypeId] == 0) PhaseReady[static_cast<int32>(Module->TickPhase)].Add(Module.Get());
 	}
-	return false;
+
+	int32 PlacedModules = 0;
+	for (int32 Phase = 0; Phase < TickerPhaseCount; ++Phase)
+	{
+		TArray<FTickerModule*>& Ready = PhaseReady[Phase];
+		while (!Ready.IsEmpty())
+		{
+			TArray<FTickerModule*>& Wave = TickWaves[Phase].Add_GetRef(MoveTemp(Ready));
+			Ready.Reset();
+			Wave.StableSort([](const FTickerModule& A, const FTickerModule& B) { return A.TickPriority < B.TickPriority; });
+			PlacedModules += Wave.Num();
+			for (const FTickerModule* Module : Wave)
+			{
+				for (FTickerModule* Dependent : Dependents[Module->ModuleTypeId])
+				{
+					if (--PendingPrerequisites[Dependent->ModuleTypeId] == 0) Ready.Add(Dependent);
+				}
+			}
+		}
+	}
+
+	if (PlacedModules == TickerModules.Num()) return;
+
+	for (const auto& Module : TickerModules)
+	{
+		if (PendingPrerequisites[Module->ModuleTypeId] == 0) continue;
+		UE_LOG(LogStaticTicker, Error, TEXT("Module '%s' has cyclic tick prerequisites, it will be ticked on the game thread after other modules of its phase"), *Module->ModuleName.ToString());
+		Module->bThreadSafeTick = false;
+		PhaseReady[static_cast<int32>(Module->TickPhase)].Add(Module.Get());
+	}
+	for (int32 Phase = 0; Phase < TickerPhaseCount; ++Phase)
+	{
+		if (!PhaseReady[Phase].IsEmpty()) TickWaves[Phase].Add(MoveTemp(PhaseReady[Phase]));
+	}
+}
+
+void FStaticTickerManager::RefreshModuleActivity(FTickerModule& Module)
+{
+	const bool bBusy = Module.NeedUpdate();
+	if (bBusy != Module.bIsBusy) SetModuleBusy(Module, bBusy);
+}
+
+void FStaticTickerManager::SetModuleBusy(FTickerModule& Module, const bool bBusy)
+{
+	const int32 Phase = static_cast<int32>(Module.TickPhase);
+	const int32 Delta = bBusy ? 1 : -1;
+	Module.bIsBusy = bBusy;
+	ActiveModuleCount += Delta;
+	PhaseActiveModuleCounts[Phase] += Delta;
+	check(ActiveModuleCount >= 0 && PhaseActiveModuleCounts[Phase] >= 0)
+
+	if (IsPhaseBound(Module.TickPhase)) PhaseTickFunctions[Phase].SetTickFunctionEnable(PhaseActiveModuleCounts[Phase] > 0);
+	else if (!bBusy && GetCoreActiveModuleCount() == 0 && TickHandle.IsValid()) EndTicker();
+}
+
+int32 FStaticTickerManager::GetCoreActiveModuleCount() const
+{
+	int32 Count = ActiveModuleCount;
+	for (int32 Phase = 1; Phase < TickerPhaseCount; ++Phase)
+	{
+		if (IsPhaseBound(static_cast<ETickerPhase>(Phase))) Count -= PhaseActiveModuleCounts[Phase];
+	}
+	return Count;
 }
 
 void FStaticTickerManager::TryStartTicker()
@@ -72,11 +298,125 @@ void FStaticTickerManager::TryStartTicker()
 		UE_LOG(LogStaticTicker, Warning, TEXT("Cannot start ticker because it is already active"));
 		return;
 	}
-	CurrentCleanupTime = 0.f;
-	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FStaticTickerManager::Tick), GlobalTickerUpdateRate);
+	if (GetCoreActiveModuleCount() == 0) return; // модули запустят тикер сами, когда у них появится работа
+	StartTicker();
+}
+
+void FStaticTickerManager::StartTicker()
+{
+	TickerTime = GetCurrentTickerTime();
+	FixedStepRealTime = GetSourceTime();
+	FixedStepAccumulator = 0.0;
+	InterpolationAlpha = bUseFixedTimeStep ? 0.f : 1.f;
+	for (const auto& Module : TickerModules) // пока тикер был выключен время для модулей не шло
+	{
+		if (IsPhaseBound(Module->TickPhase)) continue;
+		Module->LastTickTime = TickerTime;
+		ScheduleModule(*Module);
+	}
+	ArmTicker(false);
+}
+
+double FStaticTickerManager::GetModuleCurrentTime(const FTickerModule& Module) const
+{
+	if (IsPhaseBound(Module.TickPhase) || !bUseFixedTimeStep) return GetSourceTime();
+	// во время тика время шага уже выставлено, между тиками шаги ещё не отработаны
+	return bIsTicking ? TickerTime : TickerTime + FixedStepAccumulator + (GetSourceTime() - FixedStepRealTime);
+}
+
+void FStaticTickerManager::WakeModule(FTickerModule* Module)
+{
+	check(Module)
+	check(IsInGameThread()) // потокобезопасные модули не должны будить себя из Tick
+	const bool bWasIdle = !Module->bIsBusy;
+	if (bWasIdle) SetModuleBusy(*Module, true);
+
+	if (IsPhaseBound(Module->TickPhase)) // модуль обновит функция тика фазы, главный тикер ему не нужен
+	{
+		const double Time = GetSourceTime();
+		if (bWasIdle) Module->LastTickTime = Time;
+		Module->bWakeRequested = true;
+		Module->NextTickTime = FMath::Min(Module->NextTickTime, Time);
+		return;
+	}
+	bEndRequested = false;
+
+	if (!TickHandle.IsValid()) StartTicker();
+	else if (!bIsTicking && Module->TickRateType != ETickerModuleRateType::EveryFrame && bWasIdle)
+	{
+		// спящий модуль не обновлялся, пока ему было нечего делать, и не должен получить это время в DeltaTime
+		if (bUseFixedTimeStep && !DoesRequireTicker(Module))
+		{
+			// пока все модули спали, накопитель рос вхолостую, эти шаги отрабатывать некому
+			FixedStepRealTime = GetSourceTime();
+			FixedStepAccumulator = 0.0;
+		}
+		Module->LastTickTime = TickerTime = GetCurrentTickerTime();
+	}
+
+	Module->bWakeRequested = true;
+	Module->NextTickTime = FMath::Min(Module->NextTickTime, TickerTime);
+	if (!bIsTicking) ArmTicker(false);
+}
+
+void FStaticTickerManager::ScheduleModule(FTickerModule& Module) const
+{
+	if (Module.bWakeRequested || Module.bSliceRequested) // модуль получил работу во время своего Tick или не успел её закончить
+	{
+		Module.bSliceRequested = false;
+		Module.NextTickTime = Module.LastTickTime;
+		return;
+	}
+	switch (Module.TickRateType)
+	{
+		case ETickerModuleRateType::EveryFrame: Module.NextTickTime = Module.LastTickTime; break;
+		case ETickerModuleRateType::FixedRate: Module.NextTickTime = Module.LastTickTime + Module.TickRate; break;
+		case ETickerModuleRateType::Deadline:
+			Module.NextTickTime = Module.NeedUpdate() ? Module.LastTickTime + Module.GetNextUpdateDelay() : TNumericLimits<double>::Max();
+			break;
+	}
+}
+
+float FStaticTickerManager::GetTickerDelay() const
+{
+	double NextTime = TNumericLimits<double>::Max();
+	for (const auto& Module : TickerModules)
+	{
+		if (IsPhaseBound(Module->TickPhase)) continue;
+		// разбуженный модуль мог ещё не положить задачу, но тик ему уже нужен
+		if (Module->bWakeRequested ? Module->bTickInPauseDisabled && bLastPauseState : IsModuleSleeping(*Module)) continue;
+		NextTime = FMath::Min(NextTime, Module->NextTickTime);
+	}
+	if (NextTime == TNumericLimits<double>::Max()) return FMath::Max(SleepingTickerDelay, GlobalTickerUpdateRate);
+	if (bUseFixedTimeStep)
+	{
+		// дедлайн отрабатывается целым шагом, а часть времени до него уже лежит в накопителе.
+		// Спим не дольше MaxSubSteps шагов: иначе тик отбросит как фриз время, которое менеджер проспал сам
+		const double StepsToDeadline = FMath::Clamp(FMath::CeilToDouble((NextTime - TickerTime) / FixedTimeStep), 1.0, static_cast<double>(MaxSubSteps));
+		return FMath::Max(static_cast<float>(StepsToDeadline * FixedTimeStep - FixedStepAccumulator), GlobalTickerUpdateRate);
+	}
+	return FMath::Max(static_cast<float>(NextTime - TickerTime), GlobalTickerUpdateRate);
 }
 
-void FStaticTickerManager::TryEndTicker(const FTickerModule* Module) const
+bool FStaticTickerManager::ArmTicker(const bool bInsideTick)
+{
+	const float Delay = GetTickerDelay();
+	if (TickHandle.IsValid())
+	{
+		if (FMath::IsNearlyEqual(Delay, ArmedTickerDelay)) return true;
+		if (!bInsideTick) FTSTicker::GetCoreTicker().RemoveTicker(TickHandle); // внутри тика текущий делегат снимается через возврат false
+	}
+	ArmedTickerDelay = Delay;
+	TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FStaticTickerManager::Tick), Delay);
+	return false;
+}
+
+void FStaticTickerManager::StopTicker()
+{
+	if (TickHandle.IsValid()) EndTicker();
+}
+
+void FStaticTickerManager::TryEndTicker(const FTickerModule* Module)
 {
 	check(Module)
 	if (DoesRequireTicker(Module))
@@ -87,58 +427,239 @@ void FStaticTickerManager::TryEndTicker(const FTickerModule* Module) const
 	EndTicker();
 }
 
-bool FStaticTickerManager::EndTicker() const
+bool FStaticTickerManager::EndTicker()
 {
 	if (!TickHandle.IsValid())
 	{
 		UE_LOG(LogStaticTicker, Warning, TEXT("Cannot disable ticker because it is already disabled"));
 		return false;
 	}
+	if (bIsTicking) // текущий делегат снимется возвратом false из Tick
+	{
+		bEndRequested = true;
+		return true;
+	}
 	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
-	return !TickHandle.IsValid();
+	TickHandle.Reset();
+	return true;
 }
 
 void FStaticTickerManager::OnGameStarted(EWorldType::Type /*WorldType*/)
 {
 	TryAutoModifyTickerState(ETickerStateType::BeginPlay);
-	for (const auto& ModuleData : TickerModules) ModuleData.Value->OnGameStarted();
+	for (const auto& Module : TickerModules) Module->OnGameStarted();
 }
 
-void FStaticTickerManager::OnGameEnded(UWorld* /*World*/)
+void FStaticTickerManager::OnGameEnded(UWorld* World)
 {
+	if (World && TickWorld.Get() == World) UnbindTickPhases();
 	TryAutoModifyTickerState(ETickerStateType::EndPlay);
-	for (const auto& ModuleData : TickerModules) ModuleData.Value->OnGameEnded();
+	for (const auto& Module : TickerModules) Module->OnGameEnded();
 }
 
 void FStaticTickerManager::OnGamePaused(bool bPaused)
 {
+	bLastPauseState = bPaused;
 	TryAutoModifyTickerState(bPaused ? ETickerStateType::GamePaused : ETickerStateType::GameUnPaused);
-	for (const auto& ModuleData : TickerModules)
+	for (const auto& Module : TickerModules)
 	{
-		ModuleData.Value->bIsGamePaused = bPaused;
-		bPaused ? ModuleData.Value->OnGamePaused() : ModuleData.Value->OnGameUnPaused();
+		Module->bIsGamePaused = bPaused;
+		bPaused ? Module->OnGamePaused() : Module->OnGameUnPaused();
 	}
+	if (TickHandle.IsValid()) ArmTicker(false); // модули, спавшие на паузе, снова участвуют в расчёте задержки
+}
+
+void FStaticTickerManager::SetUpRegisteredModule(FTickerModule* Module, const FName ModuleName, const int32 ModuleTypeId)
+{
+	check(Module)
+	Module->OwnerManager = this;
+	Module->ModuleName = ModuleName;
+	Module->ModuleTypeId = ModuleTypeId;
+	bTickWavesDirty = true;
+#if WITH_TICKER_INSTRUMENTATION
+	Module->Instrumentation.Init(TickerStatName.IsEmpty() ? TickerDebugName : TickerStatName, TickerDebugName, ModuleName);
+#endif
+	if (!bSubscribedToGameEvents) SubscribeToGameEvents();
+}
+
+void FStaticTickerManager::SetTickerWorld(UWorld* World)
+{
+	if (!TickerWorld.IsExplicitlyNull() && TickerWorld.Get() == World) return;
+	TickerWorld = World;
+	if (World) bLastPauseState = FPauseManager::IsGamePaused(World);
+	if (bSubscribedToGameEvents) SubscribeToGameEvents(); // переносим подписку на новый мир
+}
+
+void FStaticTickerManager::SubscribeToGameEvents()
+{
+	UnsubscribeFromGameEvents();
+	bSubscribedToGameEvents = true;
+
+	if (const UWorld* World = TickerWorld.Get())
+	{
+		if (UTickerWorldSubsystem* Subsystem = World->GetSubsystem<UTickerWorldSubsystem>())
+		{
+			Subsystem->RegisterManager(this);
+			WorldSubsystem = Subsystem;
+			return;
+		}
+	}
+	GameStartedDelegateHandle = FZeonUtil::OnWorldBeginPlay.AddRaw(this, &FStaticTickerManager::HandleWorldBeginPlay);
+	GameEndedDelegateHandle = FWorldDelegates::OnWorldBeginTearDown.AddRaw(this, &FStaticTickerManager::HandleWorldTearDown);
+	GamePauseDelegateHandle = FPauseManager::OnGamePause.AddRaw(this, &FStaticTickerManager::HandleGamePause);
+}
+
+void FStaticTickerManager::UnsubscribeFromGameEvents()
+{
+	bSubscribedToGameEvents = false;
+	if (UTickerWorldSubsystem* Subsystem = WorldSubsystem.Get()) Subsystem->UnregisterManager(this);
+	WorldSubsystem.Reset();
+
+	FZeonUtil::OnWorldBeginPlay.Remove(GameStartedDelegateHandle);
+	FWorldDelegates::OnWorldBeginTearDown.Remove(GameEndedDelegateHandle);
+	FPauseManager::OnGamePause.Remove(GamePauseDelegateHandle);
+	GameStartedDelegateHandle.Reset();
+	GameEndedDelegateHandle.Reset();
+	GamePauseDelegateHandle.Reset();
+}
+
+void FStaticTickerManager::HandleWorldBeginPlay(UWorld* World, const EWorldType::Type WorldType)
+{
+	if (IsTickerWorld(World)) OnGameStarted(WorldType);
+}
+
+void FStaticTickerManager::HandleWorldTearDown(UWorld* World)
+{
+	if (IsTickerWorld(World)) OnGameEnded(World);
+}
+
+void FStaticTickerManager::HandleGamePause(const UWorld* World, const bool bPaused)
+{
+	if (IsTickerWorld(World)) OnGamePaused(bPaused);
+}
+
+void FStaticTickerManager::InsertModule(FTickerModule* Module)
+{
+	const int32 Index = Algo::UpperBound(TickerModules, Module->TickPriority, [](const int32 Priority, const TUniquePtr<FTickerModule>& Other)
+	{
+		return Priority < Other->TickPriority;
+	});
+	TickerModules.Insert(TUniquePtr<FTickerModule>(Module), Index);
+	RefreshModuleActivity(*Module);
+	RegisterPhaseTickFunction(Module->TickPhase);
+
+	if (ModulesByTypeId.Num() <= Module->ModuleTypeId) ModulesByTypeId.SetNumZeroed(Module->ModuleTypeId + 1);
+	ModulesByTypeId[Module->ModuleTypeId] = Module;
 }
 
 bool FStaticTickerManager::RegisterTickerModule(FTickerModule* Module)
 {
 	check(Module)
-	if (TickerModules.Contains(Module->ModuleName))
+	const int32 ModuleTypeId = FTickerModuleTypeRegistry::GetTypeId(Module->ModuleName);
+	if (FindModuleByTypeId(ModuleTypeId))
 	{
 		UE_LOG(LogStaticTicker, Warning, TEXT("Cannot add module '%s' because it is already added"), *Module->ModuleName.ToString());
 		return false;	
 	}
-	Module->OwnerManager = this;
-	TickerModules.Add(Module->ModuleName, TUniquePtr<FTickerModule>(std::move(Module)));
+	SetUpRegisteredModule(Module, Module->ModuleName, ModuleTypeId);
+	InsertModule(Module);
 	return true;
 }
 
 FTickerModule* FStaticTickerManager::GetTickerModuleMutable(const FName ModuleName)
 {
-	if (!TickerModules.Contains(ModuleName))
+	FTickerModule* Module = FindModuleByTypeId(FTickerModuleTypeRegistry::FindTypeId(ModuleName));
+	if (!Module) UE_LOG(LogStaticTicker, Warning, TEXT("Cannot find module: %s"), *ModuleName.ToString());
+	return Module;
+}
+
+ETickingGroup FStaticTickerManager::GetPhaseTickGroup(const ETickerPhase Phase)
+{
+	switch (Phase)
+	{
+		case ETickerPhase::PrePhysics: return TG_PrePhysics;
+		case ETickerPhase::DuringPhysics: return TG_DuringPhysics;
+		case ETickerPhase::PostPhysics: return TG_PostPhysics;
+		case ETickerPhase::PostUpdateWork: return TG_PostUpdateWork;
+		default: return TG_PrePhysics;
+	}
+}
+
+void FStaticTickerManager::BindTickPhases(UWorld* World)
+{
+	check(World)
+	if (TickWorld.Get() == World) return;
+	UnbindTickPhases();
+
+	TickWorld = World;
+	for (const auto& Module : TickerModules) RegisterPhaseTickFunction(Module->TickPhase);
+}
+
+void FStaticTickerManager::RegisterPhaseTickFunction(const ETickerPhase Phase)
+{
+	if (Phase == ETickerPhase::Core || IsPhaseBound(Phase)) return;
+	const UWorld* World = TickWorld.Get();
+	if (!World || !World->PersistentLevel) return;
+
+	const int32 PhaseIndex = static_cast<int32>(Phase);
+	FStaticTickerTickFunction& TickFunction = PhaseTickFunctions[PhaseIndex];
+	TickFunction.Manager = this;
+	TickFunction.Phase = Phase;
+	TickFunction.TickGroup = TickFunction.EndTickGroup = GetPhaseTickGroup(Phase);
+	TickFunction.bCanEverTick = true;
+	TickFunction.bStartWithTickEnabled = false;
+	TickFunction.bTickEvenWhenPaused = true; // пауза модулей обрабатывается менеджером через bTickInPauseDisabled
+	TickFunction.bAllowTickOnDedicatedServer = true;
+	TickFunction.RegisterTickFunction(World->PersistentLevel);
+
+	// модули фазы переходят с времени главного тикера на время кадра
+	const double Time = GetSourceTime();
+	for (const auto& Module : TickerModules)
+	{
+		if (Module->TickPhase != Phase) continue;
+		Module->LastTickTime = Time;
+		ScheduleModule(*Module);
+	}
+	TickFunction.SetTickFunctionEnable(PhaseActiveModuleCounts[PhaseIndex] > 0);
+
+	// занятые модули фазы больше не держат главный тикер
+	if (PhaseActiveModuleCounts[PhaseIndex] > 0 && GetCoreActiveModuleCount() == 0 && TickHandle.IsValid()) EndTicker();
+}
+
+void FStaticTickerManager::UnbindTickPhases()
+{
+	TickWorld.Reset();
+	bool bHadBoundPhases = false;
+	for (int32 Phase = 1; Phase < TickerPhaseCount; ++Phase)
 	{
-		UE_LOG(LogStaticTicker, Warning, TEXT("Cannot find module: %s"), *ModuleName.ToString());
-		return nullptr;
+		if (!IsPhaseBound(static_cast<ETickerPhase>(Phase))) continue;
+		PhaseTickFunctions[Phase].UnRegisterTickFunction();
+		bHadBoundPhases = true;
 	}
-	return TickerModules.Find(ModuleName)->Get();
-}
\ No newline at end of file
+	if (!bHadBoundPhases || GetCoreActiveModuleCount() == 0) return;
+
+	// занятые модули фаз возвращаются на главный тикер
+	if (!TickHandle.IsValid())
+	{
+		StartTicker();
+		return;
+	}
+	for (const auto& Module : TickerModules)
+	{
+		if (Module->TickPhase == ETickerPhase::Core) continue;
+		Module->LastTickTime = TickerTime;
+		ScheduleModule(*Module);
+	}
+	if (!bIsTicking) ArmTicker(false);
+}
+
+void FStaticTickerManager::SetModuleTickPhase(FTickerModule* Module, const ETickerPhase Phase)
+{
+	check(Module && Module->OwnerManager == this)
+	check(!Module->bIsBusy) // счётчики занятости ведутся по фазам, занятый модуль между ними не переносится
+	if (Module->TickPhase == Phase) return;
+
+	Module->TickPhase = Phase;
+	bTickWavesDirty = true;
+	RegisterPhaseTickFunction(Phase);
+}
@@ -0,0 +1,187 @@
+﻿
+#include "TickerBenchmark.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Tasks/Task.h"
+
+/**
+ * Замеры TickerSystem, запускаются консольными командами в сборках с WITH_TICKER_INSTRUMENTATION.
+ * Результаты пишутся в LogStaticTicker и в CSV через FTickerBenchmarkReport.
+ */
+#if WITH_TICKER_INSTRUMENTATION
+
+FTickerBenchmarkReport::FTickerBenchmarkReport(const FString& InBenchmarkName)
+	: BenchmarkName(InBenchmarkName)
+{
+}
+
+uint64 FTickerBenchmarkReport::GetAllocationCount()
+{
+#if !UE_BUILD_SHIPPING
+	return static_cast<uint64>(FMalloc::TotalMallocCalls) + static_cast<uint64>(FMalloc::TotalReallocCalls);
+#else
+	return 0;
+#endif
+}
+
+void FTickerBenchmarkReport::AddSample(const FString& Case, const int64 Size, const int64 Operations)
+{
+	const double Seconds = FPlatformTime::Seconds() - StartSeconds;
+	const uint64 Allocations = GetAllocationCount() - StartAllocations;
+	const double SafeOperations = static_cast<double>(FMath::Max<int64>(Operations, 1));
+	const double NsPerOperation = Seconds * 1e9 / SafeOperations;
+	const double AllocationsPerOperation = static_cast<double>(Allocations) / SafeOperations;
+
+	Rows.Add(FString::Printf(TEXT("%s,%s,%lld,%lld,%.3f,%.4f"), *BenchmarkName, *Case, Size, Operations, NsPerOperation, AllocationsPerOperation));
+	UE_LOG(LogStaticTicker, Display, TEXT("%s %s [%lld]: %.3f ns/op, %.4f allocs/op (%lld ops)"),
+		*BenchmarkName, *Case, Size, NsPerOperation, AllocationsPerOperation, Operations);
+}
+
+FString FTickerBenchmarkReport::Save() const
+{
+	const FString FilePath = FPaths::ProfilingDir() / TEXT("TickerBenchmarks") / FString::Printf(TEXT("%s_%s.csv"), *BenchmarkName, *FDateTime::Now().ToString());
+	FString Csv = TEXT("Benchmark,Case,Size,Operations,NsPerOperation,AllocationsPerOperation\n");
+	for (const FString& Row : Rows) Csv += Row + TEXT("\n");
+
+	if (FFileHelper::SaveStringToFile(Csv, *FilePath)) UE_LOG(LogStaticTicker, Display, TEXT("%s results saved to %s"), *BenchmarkName, *FilePath);
+	else UE_LOG(LogStaticTicker, Warning, TEXT("Cannot save %s results to %s"), *BenchmarkName, *FilePath);
+	return FilePath;
+}
+
+namespace TickerBenchmarks
+{
+	/** Модуль с минимальной работой, замеряется только стоимость планирования и обхода модулей менеджером */
+	class FBenchmarkTickerModule final : public FTickerModule
+	{
+		double Accumulated = 0.0;
+
+		virtual void Tick(float DeltaTime) override { Accumulated += DeltaTime; }
+		virtual bool NeedUpdate() const override { return true; }
+	public:
+		FBenchmarkTickerModule(const FName Name, const ETickerModuleRateType RateType, const bool bThreadSafe)
+		{
+			ModuleName = Name;
+			TickRateType = RateType;
+			TickRate = 0.05f;
+			bThreadSafeTick = bThreadSafe;
+		}
+	};
+
+	/**
+	 * Ticker.Benchmark.Modules [Ticks] [ModuleCounts...]
+	 * Стоимость тика менеджера в зависимости от количества модулей: модули каждого кадра, модули с периодом и потокобезопасные модули.
+	 */
+	void BenchmarkModules(const TArray<FString>& Args)
+	{
+		const int32 Ticks = Args.IsValidIndex(0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+		const TArray<int32> ModuleCounts = ParseSizes(Args, 1, { 16, 64, 256, 1024, 4096 });
+
+		struct FCase
+		{
+			const TCHAR* Name;
+			ETickerModuleRateType RateType;
+			bool bThreadSafe;
+		};
+		static constexpr FCase Cases[] = {
+			{ TEXT("EveryFrame"), ETickerModuleRateType::EveryFrame, false },
+			{ TEXT("FixedRate"), ETickerModuleRateType::FixedRate, false },
+			{ TEXT("ThreadSafe"), ETickerModuleRateType::EveryFrame, true },
+		};
+
+		FTickerBenchmarkReport Report(TEXT("TickerModules"));
+		for (const FCase& Case : Cases)
+		{
+			for (const int32 ModuleCount : ModuleCounts)
+			{
+				FTickerBenchmarkManager Manager;
+				for (int32 Index = 0; Index < ModuleCount; ++Index)
+				{
+					Manager.RegisterTickerModule(new FBenchmarkTickerModule(FName(TEXT("TickerBenchmarkModule"), Index + 1), Case.RateType, Case.bThreadSafe));
+				}
+				Manager.TickImmediately(); // первый тик собирает волны и взводит тикер, в замер не входит
+
+				Report.BeginSample();
+				for (int32 TickIndex = 0; TickIndex < Ticks; ++TickIndex)
+				{
+					Manager.AdvanceTime(1.0 / 60.0);
+					Manager.TickImmediately();
+				}
+				Report.AddSample(Case.Name, ModuleCount, Ticks);
+			}
+		}
+		Report.Save();
+	}
+
+	static FAutoConsoleCommand ModulesBenchmarkCommand(
+		TEXT("Ticker.Benchmark.Modules"),
+		TEXT("Benchmarks FStaticTickerManager tick cost against module count, writes CSV. Args: [Ticks] [ModuleCounts...]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkModules));
+
+	/**
+	 * Ticker.Benchmark.CommandQueue [Iterations] [Producers] [CommandsPerProducer]
+	 * Сравнивает проверку пустой очереди в начале Tick с пустым циклом и замеряет пропускную способность очереди под нагрузкой.
+	 */
+	void BenchmarkCommandQueue(const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.IsValidIndex(0) ? FCString::Atoi(*Args[0]) : 10000000;
+		const int32 Producers = Args.IsValidIndex(1) ? FCString::Atoi(*Args[1]) : 4;
+		const int32 CommandsPerProducer = Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : 100000;
+
+		FTickerBenchmarkManager Manager;
+
+		// пустая очередь: ровно та проверка, которую делает Tick
+		volatile int32 Sink = 0;
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Iterations; ++Index) Sink = Sink + 1;
+		const double BaselineTime = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Iterations; ++Index) Sink = Sink + Manager.DrainIfPending();
+		const double EmptyCheckTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogStaticTicker, Display, TEXT("CommandQueue empty check: %.3f ns/call (baseline loop %.3f ns/iteration, %d iterations)"),
+			EmptyCheckTime * 1e9 / Iterations, BaselineTime * 1e9 / Iterations, Iterations);
+
+		// нагрузка: воркеры ставят команды, игровой поток выбирает их как в начале Tick
+		std::atomic<int32> ExecutedCommands = 0;
+		const int32 TotalCommands = Producers * CommandsPerProducer;
+		TArray<UE::Tasks::FTask> ProducerTasks;
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Producer = 0; Producer < Producers; ++Producer)
+		{
+			ProducerTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [&Manager, &ExecutedCommands, CommandsPerProducer]
+			{
+				for (int32 Index = 0; Index < CommandsPerProducer; ++Index)
+				{
+					Manager.EnqueueCommand([&ExecutedCommands] { ExecutedCommands.fetch_add(1, std::memory_order_relaxed); });
+				}
+			}));
+		}
+
+		double DrainTime = 0.0;
+		int32 Drains = 0;
+		while (ExecutedCommands.load(std::memory_order_relaxed) < TotalCommands)
+		{
+			const double DrainStart = FPlatformTime::Seconds();
+			if (Manager.DrainIfPending())
+			{
+				DrainTime += FPlatformTime::Seconds() - DrainStart;
+				++Drains;
+			}
+		}
+		UE::Tasks::Wait(ProducerTasks);
+		const double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogStaticTicker, Display, TEXT("CommandQueue load: %d producers x %d commands in %.3f ms (%.1f ns/command), game thread drains %d, %.3f ms total"),
+			Producers, CommandsPerProducer, TotalTime * 1e3, TotalTime * 1e9 / FMath::Max(TotalCommands, 1), Drains, DrainTime * 1e3);
+	}
+
+	static FAutoConsoleCommand CommandQueueBenchmarkCommand(
+		TEXT("Ticker.Benchmark.CommandQueue"),
+		TEXT("Benchmarks the ticker cross-thread command queue. Args: [Iterations] [Producers] [CommandsPerProducer]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkCommandQueue));
+}
+
+#endif
@@ -0,0 +1,38 @@
+﻿
+#include "TickerInstrumentation.h"
+
+#if WITH_TICKER_INSTRUMENTATION
+
+UE_TRACE_CHANNEL_DEFINE(TickerChannel);
+
+FTickerModuleInstrumentation::~FTickerModuleInstrumentation()
+{
+#if STATS
+	// модуль удаляется, его задачи больше не должны числиться в общих счётчиках
+	ReportCount(TaskCountStatId, ReportedTaskCount, 0);
+	ReportCount(DeferredStatId, ReportedDeferredCount, 0);
+#endif
+}
+
+void FTickerModuleInstrumentation::Init(const FString& StatManagerName, const FString& TraceManagerName, const FName ModuleName)
+{
+	TraceName = FString::Printf(TEXT("%s/%s"), *TraceManagerName, *ModuleName.ToString());
+#if STATS
+	const FString StatName = FString::Printf(TEXT("%s/%s"), *StatManagerName, *ModuleName.ToString());
+	TickStatId = FDynamicStats::CreateStatId<FStatGroup_STATGROUP_TickerSystem>(StatName);
+	// счётчики не сбрасываются каждый кадр, так как складываются из вкладов модулей
+	TaskCountStatId = FDynamicStats::CreateStatIdInt64<FStatGroup_STATGROUP_TickerSystem>(StatName + TEXT(" Tasks"), true);
+	DeferredStatId = FDynamicStats::CreateStatIdInt64<FStatGroup_STATGROUP_TickerSystem>(StatName + TEXT(" Deferred"), true);
+#endif
+}
+
+#if STATS
+void FTickerModuleInstrumentation::ReportCount(const TStatId StatId, int32& ReportedCount, const int32 Count)
+{
+	if (Count == ReportedCount || !StatId.IsValidStat()) return;
+	INC_DWORD_STAT_FName_BY(StatId.GetName(), Count - ReportedCount);
+	ReportedCount = Count;
+}
+#endif
+
+#endif
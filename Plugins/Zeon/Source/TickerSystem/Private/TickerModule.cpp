@@ -1,10 +1,34 @@
 ﻿
 #include "TickerModule.h"
 #include "StaticTickerManager.h"
+#include "Misc/ScopeRWLock.h"
 
-void FTickerModule::TryStartTicker() const
+namespace TickerModuleTypeRegistry
 {
-	if (OwnerManager) OwnerManager->TryStartTicker();
+	FRWLock Lock;
+	TMap<FName, int32> TypeIds;
+}
+
+int32 FTickerModuleTypeRegistry::GetTypeId(const FName ModuleName)
+{
+	using namespace TickerModuleTypeRegistry;
+	if (const int32 TypeId = FindTypeId(ModuleName); TypeId != INDEX_NONE) return TypeId;
+
+	FWriteScopeLock WriteLock(Lock);
+	return TypeIds.FindOrAdd(ModuleName, TypeIds.Num());
+}
+
+int32 FTickerModuleTypeRegistry::FindTypeId(const FName ModuleName)
+{
+	using namespace TickerModuleTypeRegistry;
+	FReadScopeLock ReadLock(Lock);
+	const int32* TypeId = TypeIds.Find(ModuleName);
+	return TypeId ? *TypeId : INDEX_NONE;
+}
+
+void FTickerModule::TryStartTicker()
+{
+	if (OwnerManager) OwnerManager->WakeModule(this);
 }
 
 void FTickerModule::TryEndTicker() const
@@ -12,7 +36,23 @@ void FTickerModule::TryEndTicker() const
 	if (OwnerManager) OwnerManager->TryEndTicker(this);
 }
 
-void FTickerModule::TryEndTickerSave() const
+void FTickerModule::TryEndTickerSave()
+{
+	if (OwnerManager) OwnerManager->RefreshModuleActivity(*this);
+}
+
+float FTickerModule::GetInterpolationAlpha() const
+{
+	return OwnerManager && !OwnerManager->IsPhaseBound(TickPhase) ? OwnerManager->InterpolationAlpha : 1.f;
+}
+
+double FTickerModule::GetTimeSinceLastTick() const
+{
+	if (!OwnerManager || !bIsBusy || (bTickInPauseDisabled && bIsGamePaused)) return 0.0;
+	return FMath::Max(OwnerManager->GetModuleCurrentTime(*this) - LastTickTime, 0.0);
+}
+
+bool FTickerModule::HasFrameBudget() const
 {
-	if (!NeedUpdate()) TryEndTicker();
+	return !OwnerManager || FPlatformTime::Seconds() < OwnerManager->FrameBudgetEndTime;
 }
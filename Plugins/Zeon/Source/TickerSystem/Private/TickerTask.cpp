@@ -0,0 +1,71 @@
+﻿
+#include "TickerTask.h"
+#include "CoroutineTickerModule.h"
+
+namespace TickerTaskFramePool
+{
+	/** Кадры округляются до 64 байт, кадры больше MaxPooledSize идут напрямую в аллокатор */
+	constexpr SIZE_T Granularity = 64;
+	constexpr SIZE_T MaxPooledSize = 2048;
+	constexpr int32 BucketCount = MaxPooledSize / Granularity;
+
+	/** Сколько свободных кадров хранится в одном размерном классе после пика запусков */
+	constexpr int32 MaxFramesPerBucket = 256;
+
+	TArray<void*> FreeFrames[BucketCount];
+
+	FORCEINLINE int32 GetBucket(const SIZE_T Size)
+	{
+		return static_cast<int32>((Size + Granularity - 1) / Granularity) - 1;
+	}
+}
+
+void* FTickerTaskFramePool::Allocate(const SIZE_T Size)
+{
+	using namespace TickerTaskFramePool;
+	check(IsInGameThread())
+	if (Size > MaxPooledSize) return FMemory::Malloc(Size);
+
+	const int32 Bucket = GetBucket(Size);
+	if (!FreeFrames[Bucket].IsEmpty()) return FreeFrames[Bucket].Pop(EAllowShrinking::No);
+	return FMemory::Malloc((Bucket + 1) * Granularity);
+}
+
+void FTickerTaskFramePool::Free(void* Frame, const SIZE_T Size)
+{
+	using namespace TickerTaskFramePool;
+	check(IsInGameThread())
+	if (Size > MaxPooledSize)
+	{
+		FMemory::Free(Frame);
+		return;
+	}
+	TArray<void*>& Bucket = FreeFrames[GetBucket(Size)];
+	if (Bucket.Num() >= MaxFramesPerBucket) FMemory::Free(Frame);
+	else Bucket.Add(Frame);
+}
+
+void FTickerTaskFramePool::Trim()
+{
+	using namespace TickerTaskFramePool;
+	check(IsInGameThread())
+	for (TArray<void*>& Bucket : FreeFrames)
+	{
+		for (void* Frame : Bucket) FMemory::Free(Frame);
+		Bucket.Empty();
+	}
+}
+
+void TickerTask::FNextTickAwaiter::await_suspend(FTickerTask::FHandle Coroutine) const
+{
+	const auto& Promise = Coroutine.promise();
+	check(Promise.Module)
+	Promise.Module->Resume(Promise.Handle);
+}
+
+void TickerTask::FSecondsAwaiter::await_suspend(FTickerTask::FHandle Coroutine) const
+{
+	const auto& Promise = Coroutine.promise();
+	check(Promise.Module)
+	Promise.Module->ResumeAfter(Promise.Handle, Seconds);
+}
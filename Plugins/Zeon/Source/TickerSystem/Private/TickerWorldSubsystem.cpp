@@ -0,0 +1,68 @@
+﻿
+#include "TickerWorldSubsystem.h"
+#include "StaticTickerManager.h"
+#include "Utility/PauseManager.h"
+
+template<typename FunctionT>
+void UTickerWorldSubsystem::ForEachManager(FunctionT Function)
+{
+	// копия, так как обработчики могут добавлять и убирать менеджеры
+	for (FStaticTickerManager* Manager : TArray<FStaticTickerManager*>(Managers))
+	{
+		if (Managers.Contains(Manager)) Function(Manager);
+	}
+}
+
+bool UTickerWorldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTickerWorldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	WorldBeginPlayDelegateHandle = GetWorldRef().OnWorldBeginPlay.AddUObject(this, &UTickerWorldSubsystem::OnWorldStarted);
+	WorldTearDownDelegateHandle = FWorldDelegates::OnWorldBeginTearDown.AddUObject(this, &UTickerWorldSubsystem::OnWorldTearDown);
+	GamePauseDelegateHandle = FPauseManager::OnGamePause.AddUObject(this, &UTickerWorldSubsystem::OnGamePause);
+}
+
+void UTickerWorldSubsystem::Deinitialize()
+{
+	GetWorldRef().OnWorldBeginPlay.Remove(WorldBeginPlayDelegateHandle);
+	FWorldDelegates::OnWorldBeginTearDown.Remove(WorldTearDownDelegateHandle);
+	FPauseManager::OnGamePause.Remove(GamePauseDelegateHandle);
+
+	// менеджеры могут пережить мир, дальше они не получают событий и не обращаются к подсистеме
+	for (FStaticTickerManager* Manager : Managers) Manager->WorldSubsystem.Reset();
+	Managers.Empty();
+	Super::Deinitialize();
+}
+
+void UTickerWorldSubsystem::OnWorldStarted()
+{
+	const EWorldType::Type WorldType = GetWorldRef().WorldType;
+	ForEachManager([WorldType](FStaticTickerManager* Manager) { Manager->OnGameStarted(WorldType); });
+}
+
+void UTickerWorldSubsystem::OnWorldTearDown(UWorld* World)
+{
+	if (World != GetWorld()) return;
+	ForEachManager([World](FStaticTickerManager* Manager) { Manager->OnGameEnded(World); });
+}
+
+void UTickerWorldSubsystem::OnGamePause(const UWorld* World, const bool bPaused)
+{
+	if (World != GetWorld()) return;
+	ForEachManager([bPaused](FStaticTickerManager* Manager) { Manager->OnGamePaused(bPaused); });
+}
+
+void UTickerWorldSubsystem::RegisterManager(FStaticTickerManager* Manager)
+{
+	check(Manager)
+	Managers.AddUnique(Manager);
+}
+
+void UTickerWorldSubsystem::UnregisterManager(FStaticTickerManager* Manager)
+{
+	Managers.RemoveSingle(Manager);
+}
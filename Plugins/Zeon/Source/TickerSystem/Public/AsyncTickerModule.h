@@ -0,0 +1,99 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TickerModule.h"
+#include "Tasks/Task.h"
+
+/**
+ * Модуль, основная работа которого выполняется на воркере через UE::Tasks, а результат забирается на следующем тике менеджера.
+ * На игровом потоке модуль только снимает копию входных данных и публикует готовый результат, поэтому подходит для расчётов,
+ * результат которых можно использовать с опозданием на кадр (агрегация атрибутов, оценка способностей для AI и т.п.).
+ *
+ * Тик модуля на игровом потоке:
+ *	- если задача прошлого тика ещё считается, модуль её не ждёт и просит менеджер обновить его на следующем тике;
+ *	- готовый результат публикуется через SwapAsyncResults;
+ *	- если есть работа (NeedAsyncUpdate), входные данные копируются через GatherAsyncInput и запускается TickAsync на воркере.
+ * DeltaTime тиков, в которые задача не запускалась, накапливается и уходит в следующий запуск.
+ * Модули с FixedRate и Deadline забирают результат отдельным тиком сразу после запуска, а следующий запуск идёт по их расписанию.
+ *
+ * TickAsync не должен трогать UObject, менеджер и данные модуля, кроме снятых входных данных и буфера результата.
+ * Обычно модуль наследуется от TAsyncTickerModule, который хранит входные данные и двойной буфер результата.
+ */
+class TICKERSYSTEM_API FAsyncTickerModule : public FTickerModule
+{
+	/** Задача воркера, запущенная на прошлом тике */
+	UE::Tasks::FTask AsyncTickTask;
+
+	/** DeltaTime, накопленный с последнего запуска задачи */
+	float PendingAsyncDeltaTime = 0.f;
+
+	bool bAsyncTickInFlight = false;
+
+	/** Следующий тик модуля только забирает результат, запуск задачи идёт по расписанию модуля */
+	bool bCollectTick = false;
+
+	virtual void Tick(float DeltaTime) override final;
+	virtual bool NeedUpdate() const override final { return bAsyncTickInFlight || NeedAsyncUpdate(); }
+protected:
+	FAsyncTickerModule();
+	virtual ~FAsyncTickerModule() override;
+
+	/** Есть ли у модуля работа для следующего запуска, аналог NeedUpdate обычного модуля */
+	virtual bool NeedAsyncUpdate() const { return false; }
+
+	/** Игровой поток: копирует входные данные для TickAsync */
+	virtual void GatherAsyncInput(float DeltaTime) = 0;
+
+	/** Воркер: считает результат по снятым входным данным */
+	virtual void TickAsync(float DeltaTime) = 0;
+
+	/** Игровой поток: делает результат последней задачи текущим */
+	virtual void SwapAsyncResults() = 0;
+
+	/** Ждёт задачу воркера, если она запущена. Вызывается перед удалением данных, которые она использует */
+	void WaitForAsyncTick();
+
+	/** Считается ли сейчас задача воркера */
+	FORCEINLINE bool IsAsyncTickInFlight() const { return bAsyncTickInFlight; }
+
+	/** Приоритет задачи воркера */
+	UE::Tasks::ETaskPriority AsyncTaskPriority = UE::Tasks::ETaskPriority::Normal;
+};
+
+/**
+ * FAsyncTickerModule с входными данными InputT и двойным буфером результата ResultT.
+ * Воркер пишет в задний буфер, игровой поток читает передний через GetAsyncResults, буферы меняются на тике после завершения задачи.
+ * Задний буфер хранит результат позапрошлого запуска, ComputeAsyncResults должна перезаписать его целиком,
+ * зато массивы внутри ResultT переиспользуют память и запуск не ходит в аллокатор.
+ */
+template<typename InputT, typename ResultT>
+class TAsyncTickerModule : public FAsyncTickerModule
+{
+	InputT AsyncInput;
+	ResultT AsyncResults[2];
+	int32 FrontResultIndex = 0;
+
+	virtual void GatherAsyncInput(const float DeltaTime) override final { GatherInput(AsyncInput, DeltaTime); }
+	virtual void TickAsync(const float DeltaTime) override final { ComputeAsyncResults(AsyncInput, AsyncResults[FrontResultIndex ^ 1], DeltaTime); }
+	virtual void SwapAsyncResults() override final
+	{
+		FrontResultIndex ^= 1;
+		OnAsyncResultsPublished(AsyncResults[FrontResultIndex]);
+	}
+protected:
+	/** Игровой поток: заполняет входные данные запуска */
+	virtual void GatherInput(InputT& OutInput, float DeltaTime) = 0;
+
+	/** Воркер: считает результат в задний буфер */
+	virtual void ComputeAsyncResults(const InputT& Input, ResultT& OutResults, float DeltaTime) = 0;
+
+	/** Игровой поток: вызывается после смены буферов, здесь результат раздаётся игровым объектам */
+	virtual void OnAsyncResultsPublished(const ResultT& Results) {}
+public:
+	/** Буферы удаляются раньше базового модуля, поэтому задачу ждём здесь */
+	virtual ~TAsyncTickerModule() override { WaitForAsyncTick(); }
+
+	/** Последний опубликованный результат, только на игровом потоке */
+	FORCEINLINE const ResultT& GetAsyncResults() const { return AsyncResults[FrontResultIndex]; }
+};
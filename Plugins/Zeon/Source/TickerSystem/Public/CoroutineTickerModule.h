@@ -0,0 +1,90 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TickerModule.h"
+#include "TickerTask.h"
+
+/**
+ * Модуль, выполняющий корутины FTickerTask.
+ * Корутины, ждущие время, лежат в куче по дедлайну, и модуль просыпается только к ближайшему из них.
+ * Корутины, ждущие внешнего события, модуль не обновляет вовсе: событие возвращает их через Resume.
+ */
+class TICKERSYSTEM_API FCoroutineTickerModule : public FTickerModule
+{
+	GENERATED_TICKER_BODY("CoroutineTickerModule")
+
+	struct FTaskSlot
+	{
+		FTickerTask::FHandle Coroutine;
+		uint32 Serial = 0;
+
+		/** Корутина сейчас на стеке resume, уничтожать её кадр можно только после возврата */
+		bool bExecuting = false;
+
+		/** Корутину отменили во время её выполнения, кадр уничтожит ResumeTask */
+		bool bCancelled = false;
+	};
+
+	struct FTaskDeadline
+	{
+		double WakeTime;
+		FTickerTaskHandle Handle;
+
+		FORCEINLINE bool operator<(const FTaskDeadline& Other) const { return WakeTime < Other.WakeTime; }
+	};
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool NeedUpdate() const override;
+	virtual double GetNextUpdateDelay() const override;
+	virtual int32 GetActiveTaskCount() const override { return Tasks.Num(); }
+
+	/** Возобновляет корутину и уничтожает её кадр, если она завершилась */
+	void ResumeTask(const FTickerTaskHandle& Handle);
+	void DestroyTask(const int32 Index);
+
+	FORCEINLINE bool IsHandleAlive(const FTickerTaskHandle& Handle) const
+	{
+		return IsSlotOwned(Handle) && !Tasks[Handle.Index].bCancelled;
+	}
+
+	/** Ячейка ещё принадлежит корутине хендла, даже если её отменили во время выполнения */
+	FORCEINLINE bool IsSlotOwned(const FTickerTaskHandle& Handle) const
+	{
+		return Tasks.IsValidIndex(Handle.Index) && Tasks.IsAllocated(Handle.Index) && Tasks[Handle.Index].Serial == Handle.Serial;
+	}
+
+	/** Время модуля, растёт только во время тика */
+	double CurrentTime = 0.0;
+	uint32 NextSerial = 1;
+
+	TSparseArray<FTaskSlot> Tasks;
+
+	/** Корутины, которые нужно возобновить на ближайшем тике, и буфер для их обработки */
+	TArray<FTickerTaskHandle> NextTickTasks;
+	TArray<FTickerTaskHandle> ResumingTasks;
+
+	/** Куча корутин по времени возобновления */
+	TArray<FTaskDeadline> DeadlineTasks;
+public:
+	FCoroutineTickerModule();
+	virtual ~FCoroutineTickerModule() override;
+
+	FCoroutineTickerModule(const FCoroutineTickerModule&) = delete;
+	FCoroutineTickerModule& operator=(const FCoroutineTickerModule&) = delete;
+
+	/** Запускает корутину: она выполняется сразу до первого co_await */
+	FTickerTaskHandle Launch(FTickerTask&& Task);
+
+	/** Уничтожает корутину, деструкторы её локальных переменных вызываются сразу */
+	void Cancel(const FTickerTaskHandle& Handle);
+
+	/** Планирует корутину на ближайший тик, используется внешними событиями для возобновления ждущих корутин */
+	void Resume(const FTickerTaskHandle& Handle);
+
+	/** Планирует корутину на время модуля через Seconds секунд */
+	void ResumeAfter(const FTickerTaskHandle& Handle, const float Seconds);
+
+	/** Выполняется ли ещё корутина, запущенная с этим идентификатором */
+	FORCEINLINE bool IsTaskRunning(const FTickerTaskHandle& Handle) const { return IsHandleAlive(Handle); }
+};
@@ -4,6 +4,10 @@
 #include "CoreMinimal.h"
 #include "TickerModule.h"
 #include "Containers/Ticker.h"
+#include "Misc/App.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Containers/Queue.h"
+#include <atomic>
 #include "Utility/Invoker.h"
 
 /** Enum для выбора ивента для активации или де активации тикера */
@@ -20,28 +24,233 @@ enum class ETickerStateType : uint8
 
 DECLARE_LOG_CATEGORY_EXTERN(LogStaticTicker, Log, All);
 
+class FStaticTickerManager;
+class UTickerWorldSubsystem;
+
+/** Функция тика мира, через которую менеджер обновляет модули одной фазы в её группе тика */
+struct TICKERSYSTEM_API FStaticTickerTickFunction : public FTickFunction
+{
+	FStaticTickerManager* Manager = nullptr;
+	ETickerPhase Phase = ETickerPhase::Core;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
 /** Класс, обеспечивающая централизованное управление логикой, работающей во времени через систему модулей. */
 class TICKERSYSTEM_API FStaticTickerManager
 {
 	friend FTickerModule;
+	friend FStaticTickerTickFunction;
+	friend UTickerWorldSubsystem;
+
+	static constexpr int32 TickerPhaseCount = static_cast<int32>(ETickerPhase::Num);
 	
 	bool Tick(float DeltaTime);
-	bool CleanupManager(float DeltaTime);
+
+	/** Тик фазы мира, вызывается функцией тика фазы в её группе */
+	void TickPhase(const ETickerPhase Phase);
+
+	/** Один проход по всем волнам модулей, которые обновляет главный тикер, на текущем времени менеджера */
+	void TickModules();
+
+	/** Выполняет одну волну модулей: игровые модули по очереди, потокобезопасные через ParallelFor */
+	void TickWave(const TArray<FTickerModule*>& Wave, const double Time);
+
+	/**
+	 * Раскладывает модули каждой фазы на волны по их TickPrerequisites: в одной волне лежат модули, которые не зависят друг от друга.
+	 * Модули с циклическими зависимостями уходят в последнюю волну фазы и обновляются только на игровом потоке.
+	 */
+	void BuildTickWaves();
+
+	/** Обновляется ли фаза своей функцией тика мира. Фаза Core и непривязанные фазы обновляет главный тикер */
+	FORCEINLINE bool IsPhaseBound(const ETickerPhase Phase) const
+	{
+		return Phase != ETickerPhase::Core && PhaseTickFunctions[static_cast<int32>(Phase)].IsTickFunctionRegistered();
+	}
+
+	/** Количество занятых модулей, которые обновляет главный тикер */
+	int32 GetCoreActiveModuleCount() const;
 	
-	bool DoesRequireTicker(const FTickerModule* IgnoreModule) const;
+	/** Нужен ли главный тикер хоть одному модулю, кроме IgnoreModule. Считается по счётчикам занятых модулей, без обхода */
+	FORCEINLINE bool DoesRequireTicker(const FTickerModule* IgnoreModule) const
+	{
+		const bool bIgnoreBusy = IgnoreModule && IgnoreModule->bIsBusy && !IsPhaseBound(IgnoreModule->TickPhase);
+		return GetCoreActiveModuleCount() - (bIgnoreBusy ? 1 : 0) > 0;
+	}
+
+	/**
+	 * Сверяет занятость модуля с его NeedUpdate и обновляет счётчик занятых модулей.
+	 * Когда последний модуль освобождается, тикер снимается сразу, без периодической проверки.
+	 */
+	void RefreshModuleActivity(FTickerModule& Module);
+
+	/**
+	 * Меняет занятость модуля и счётчики его фазы. Функция тика фазы мира включена, только пока в фазе есть занятые модули,
+	 * главный тикер снимается, когда освобождается последний его модуль.
+	 */
+	void SetModuleBusy(FTickerModule& Module, const bool bBusy);
+
+	/** Регистрирует функцию тика фазы в мире привязки, модули фазы переходят с главного тикера на неё */
+	void RegisterPhaseTickFunction(const ETickerPhase Phase);
 	
 	void TryStartTicker();
-	void TryEndTicker(const FTickerModule* Module) const;
-	bool EndTicker() const;
+	void TryEndTicker(const FTickerModule* Module);
+	bool EndTicker();
+
+	/**
+	 * Связывает модуль с менеджером. На первом модуле менеджер подписывается на события мира и паузы,
+	 * поэтому менеджеры без модулей (например системы на общем тикере) ни на что не подписаны.
+	 */
+	void SetUpRegisteredModule(FTickerModule* Module, const FName ModuleName, const int32 ModuleTypeId);
+
+	/**
+	 * Подписывает менеджер на начало игры, завершение мира и паузу. Менеджер с миром регистрируется в UTickerWorldSubsystem
+	 * и получает события только своего мира, менеджер без мира (или мир без подсистемы) подписывается на глобальные делегаты.
+	 */
+	void SubscribeToGameEvents();
+	void UnsubscribeFromGameEvents();
+
+	/** Обработчики глобальных делегатов, отбрасывают события чужих миров */
+	void HandleWorldBeginPlay(UWorld* World, EWorldType::Type WorldType);
+	void HandleWorldTearDown(UWorld* World);
+	void HandleGamePause(const UWorld* World, bool bPaused);
+
+	/** Относится ли событие мира к менеджеру: менеджер без мира принимает события всех миров */
+	FORCEINLINE bool IsTickerWorld(const UWorld* World) const
+	{
+		return TickerWorld.IsExplicitlyNull() || TickerWorld.Get() == World;
+	}
+
+	/** Вставляет модуль в массив модулей по его TickPriority и в таблицу по номеру типа */
+	void InsertModule(FTickerModule* Module);
+
+	FORCEINLINE FTickerModule* FindModuleByTypeId(const int32 ModuleTypeId) const
+	{
+		return ModulesByTypeId.IsValidIndex(ModuleTypeId) ? ModulesByTypeId[ModuleTypeId] : nullptr;
+	}
+
+	/** Запускает главный тикер и синхронизирует время его модулей с текущим временем менеджера */
+	void StartTicker();
+
+	/** Будит модуль к ближайшему тику менеджера, вызывается когда у модуля появилась новая работа */
+	void WakeModule(FTickerModule* Module);
+
+	/** Рассчитывает время следующего Tick модуля по его режиму планирования */
+	void ScheduleModule(FTickerModule& Module) const;
+
+	/** Задержка главного тикера до ближайшего дедлайна среди модулей, которым нужно обновление */
+	float GetTickerDelay() const;
+
+	/**
+	 * Взводит главный тикер на задержку до ближайшего дедлайна, если она изменилась.
+	 * Возвращает false, если был зарегистрирован новый делегат и текущий нужно снять.
+	 */
+	bool ArmTicker(bool bInsideTick);
+
+	/** Текущее время для менеджера: реальное время, либо время симуляции в режиме фиксированного шага */
+	FORCEINLINE double GetCurrentTickerTime() const
+	{
+		return bUseFixedTimeStep ? TickerTime : GetSourceTime();
+	}
+
+	/**
+	 * Текущее время в шкале LastTickTime модуля. Между тиками модуль может долго спать до своего дедлайна,
+	 * поэтому время берётся из источника, а в режиме фиксированного шага к времени симуляции добавляется ещё не отработанное время.
+	 */
+	double GetModuleCurrentTime(const FTickerModule& Module) const;
+
+	FORCEINLINE bool IsModuleSleeping(const FTickerModule& Module) const
+	{
+		return !Module.NeedUpdate() || (Module.bTickInPauseDisabled && bLastPauseState);
+	}
+
+	/** Группа тика мира для фазы */
+	static ETickingGroup GetPhaseTickGroup(const ETickerPhase Phase);
 
 	bool bLastPauseState = false;
-	float CurrentCleanupTime = 0.f;
-	float CurrentPauseUpdateTime = 0.f;
+	bool bIsTicking = false;
+
+	/** Тикер остановлен во время Tick, делегат снимется возвратом false */
+	bool bEndRequested = false;
+	bool bSubscribedToGameEvents = false;
+	bool bTickWavesDirty = true;
+	float ArmedTickerDelay = 0.f;
+
+	/** Количество модулей, у которых есть работа (NeedUpdate) */
+	int32 ActiveModuleCount = 0;
+
+	/** Количество занятых модулей по фазам, тикер фазы работает только пока оно больше нуля */
+	int32 PhaseActiveModuleCounts[TickerPhaseCount] = {};
+
+	/** Время менеджера, по нему модули получают DeltaTime и планируют свои дедлайны */
+	double TickerTime = 0.0;
+
+	/** Реальное время, до которого накопитель фиксированного шага уже учтён */
+	double FixedStepRealTime = 0.0;
+
+	/** Реальное время, ещё не отработанное шагами симуляции */
+	double FixedStepAccumulator = 0.0;
+
+	/** Доля неотработанного шага, от 0 до 1 */
+	float InterpolationAlpha = 1.f;
+
+	/** Значение FPlatformTime::Seconds, после которого бюджет текущего тика исчерпан */
+	double FrameBudgetEndTime = TNumericLimits<double>::Max();
 	FTSTicker::FDelegateHandle TickHandle;
 	FDelegateHandle GameEndedDelegateHandle;
 	FDelegateHandle GameStartedDelegateHandle;
 	FDelegateHandle GamePauseDelegateHandle;
-	TMap<FName, TUniquePtr<FTickerModule>> TickerModules;
+	/** Модули менеджера, отсортированы по TickPriority, при равном приоритете в порядке добавления */
+	TArray<TUniquePtr<FTickerModule>> TickerModules;
+
+	/** Модули по номеру их типа, типизированный поиск модуля - одно чтение из массива */
+	TArray<FTickerModule*> ModulesByTypeId;
+
+	/** Модули, разложенные по фазам и волнам зависимостей, пересобираются при регистрации нового модуля */
+	TArray<TArray<FTickerModule*>> TickWaves[TickerPhaseCount];
+
+	/** Функции тика фаз мира по индексу фазы, для фазы Core не используется */
+	FStaticTickerTickFunction PhaseTickFunctions[TickerPhaseCount];
+
+	/** Мир, в группах тика которого обновляются фазы модулей */
+	TWeakObjectPtr<UWorld> TickWorld;
+
+	/** Мир менеджера, события начала игры, завершения и паузы принимаются только от него */
+	TWeakObjectPtr<UWorld> TickerWorld;
+
+	/** Подсистема мира, через которую менеджер получает события, если он на неё подписан */
+	TWeakObjectPtr<UTickerWorldSubsystem> WorldSubsystem;
+
+	/** Переиспользуемые буферы модулей волны, которым нужен Tick */
+	TArray<FTickerModule*> DueGameThreadModules;
+	TArray<FTickerModule*> DueThreadSafeModules;
+
+	/** Команды из других потоков, lock-free очередь с одним потребителем - игровым потоком */
+	TQueue<TInvoker<void()>, EQueueMode::Mpsc> PendingCommands;
+
+	/** Поставлена ли уже задача игрового потока на выполнение команд */
+	std::atomic<bool> bCommandsWakeScheduled = false;
+
+	/** Токен времени жизни менеджера, задачи игрового потока из EnqueueCommand обращаются к менеджеру только через него */
+	TSharedRef<FStaticTickerManager*, ESPMode::ThreadSafe> LifetimeToken;
+public:
+	/**
+	 * Потокобезопасно ставит команду в очередь менеджера. Первая команда после опустошения очереди всегда ставит одну задачу
+	 * игрового потока, независимо от того, запущен ли тикер: спящий до дальнего дедлайна тикер не должен задерживать команды.
+	 * Очередь выполняется тем, что наступит раньше - этой задачей или началом Tick/TickPhase, обычно это задача.
+	 * Так async колбэки и задачи воркеров могут добавлять работу модулям. Менеджер должен быть жив на момент вызова.
+	 */
+	void EnqueueCommand(TInvoker<void()>&& Command);
+
+	/**
+	 * Функция тика фазы мира или nullptr, если фаза не привязана к миру.
+	 * Нужна чтобы поставить тик компонента после модулей фазы через AddPrerequisite.
+	 */
+	FORCEINLINE FTickFunction* GetPhaseTickFunction(const ETickerPhase Phase)
+	{
+		return IsPhaseBound(Phase) ? &PhaseTickFunctions[static_cast<int32>(Phase)] : nullptr;
+	}
 protected:
 	FStaticTickerManager();
 	virtual ~FStaticTickerManager();
@@ -52,14 +261,38 @@ protected:
 	virtual void OnGameStarted(EWorldType::Type WorldType);
 	virtual void OnGameEnded(UWorld* World);
 	virtual void OnGamePaused(bool bPaused);
+
+	/** Источник реального времени менеджера, все чтения времени идут через него */
+	virtual double GetSourceTime() const { return FApp::GetCurrentTime(); }
 	
-	/** Использовать ли систему проверки занятости тикера */
-	bool bUseCleanupSystem = true;
+	/** Имя менеджера в профайлере, задаётся до добавления модулей, так как их счётчики создаются при регистрации */
+	FString TickerDebugName = TEXT("StaticTickerManager");
+
+	/**
+	 * Имя STAT счётчиков модулей, пустое - совпадает с TickerDebugName. Задаётся, если у каждого экземпляра своё TickerDebugName:
+	 * динамические статы не удаляются, поэтому имя экземпляра оставляется только трейсу, а счётчики экземпляров складываются.
+	 */
+	FString TickerStatName;
+
+	/**
+	 * Режим фиксированного шага: время модулей растёт ровно на FixedTimeStep за шаг независимо от частоты кадров,
+	 * накопленное реальное время отрабатывается несколькими шагами за кадр, но не больше MaxSubSteps.
+	 */
+	bool bUseFixedTimeStep = false;
+
+	/** Длина шага симуляции в секундах, используется только с bUseFixedTimeStep */
+	float FixedTimeStep = 1.f / 120.f;
 
-	/** Частота проверки занятость тикера */
-	float CleanupRate = 30.f;
+	/** Максимум шагов за один тик менеджера, остаток времени после фриза отбрасывается */
+	int32 MaxSubSteps = 4;
 
-	/** Частота обновления главного тикера */
+	/**
+	 * Бюджет одного тика менеджера в микросекундах, 0 - без ограничения.
+	 * Модули сами проверяют его через HasFrameBudget и переносят остаток работы на следующий тик.
+	 */
+	float FrameBudgetMicroseconds = 0.f;
+
+	/** Минимальная задержка главного тикера, модули с ETickerModuleRateType::EveryFrame обновляются с этой частотой */
 	float GlobalTickerUpdateRate = 0.001;
 
 	/** Список триггеров, при активации одного из них, система попытается активировать тикер */
@@ -88,6 +321,39 @@ protected:
 	template<typename T>
 	const T* GetTickerModule() const;
 
+	/**
+	 * Ограничивает менеджер событиями одного мира: пауза, начало игры и завершение других миров (клиенты PIE, listen сервер)
+	 * его больше не затрагивают. Задаётся до добавления модулей или в любой момент позже, подписка переносится сама.
+	 */
+	void SetTickerWorld(UWorld* World);
+
+	/**
+	 * Привязывает фазы модулей к группам тика мира: для каждой фазы с модулями регистрируется своя функция тика.
+	 * Без привязки модули любых фаз обновляются главным тикером. Привязка снимается при завершении мира или через UnbindTickPhases.
+	 */
+	void BindTickPhases(UWorld* World);
+
+	/** Снимает функции тика фаз, модули фаз возвращаются на главный тикер */
+	void UnbindTickPhases();
+
+	/** Меняет фазу модуля, пока у него нет работы. Обычно вызывается сразу после AddTickerModule */
+	void SetModuleTickPhase(FTickerModule* Module, const ETickerPhase Phase);
+
+	/**
+	 * Выполняет тик главного тикера сразу, не дожидаясь FTSTicker, время берётся из GetSourceTime как обычно.
+	 * Нужен для замеров и ручного управления временем, только на игровом потоке и не изнутри тика.
+	 */
+	void TickImmediately();
+
+	/** Снимает главный тикер, если он запущен. Владелец вызывает его при завершении работы, модули с новой работой запустят тикер снова */
+	void StopTicker();
+
+	/** Выполняет команды из EnqueueCommand, только на игровом потоке */
+	void ExecutePendingCommands();
+
+	/** Есть ли невыполненные команды. Пустая очередь проверяется одним чтением без блокировок */
+	FORCEINLINE bool HasPendingCommands() const { return !PendingCommands.IsEmpty(); }
+
 	/** Вызывает состояние активации или де активации тикера */
 	FORCEINLINE void TryAutoModifyTickerState(const ETickerStateType& TickerState)
 	{
@@ -112,36 +378,30 @@ private:
 template <typename T>
 T* FStaticTickerManager::AddTickerModule()
 {
-	const auto& ModuleName = T::GetModuleName();
-	if (TickerModules.Contains(ModuleName))
+	const int32 ModuleTypeId = T::GetModuleTypeId();
+	if (FindModuleByTypeId(ModuleTypeId))
 	{
-		LogTickerWarning(FString::Printf(TEXT("Cannot add module '%s' because it is already added"), *ModuleName.ToString()));
+		LogTickerWarning(FString::Printf(TEXT("Cannot add module '%s' because it is already added"), *T::GetModuleName().ToString()));
 		return nullptr;	
 	}
 	if (T* NewModule = new T())
 	{
-		NewModule->OwnerManager = this;
-		TickerModules.Add(ModuleName, TUniquePtr<FTickerModule>(std::move(NewModule)));
+		SetUpRegisteredModule(NewModule, T::GetModuleName(), ModuleTypeId);
+		InsertModule(NewModule);
 		return NewModule;
 	}
-	LogTickerError(FString::Printf(TEXT("Cannot create module: %s"), *ModuleName.ToString()));
+	LogTickerError(FString::Printf(TEXT("Cannot create module: %s"), *T::GetModuleName().ToString()));
 	return nullptr;
 }
 
 template <typename T>
 T* FStaticTickerManager::GetTickerModuleMutable()
 {
-	const FName ModuleName = T::GetModuleName();
-	const auto* Found = TickerModules.Find(ModuleName);
-	if (!Found) return nullptr;
-	return static_cast<T*>(Found->Get());
+	return static_cast<T*>(FindModuleByTypeId(T::GetModuleTypeId()));
 }
 
 template <typename T>
 const T* FStaticTickerManager::GetTickerModule() const
 {
-	const FName ModuleName = T::GetModuleName();
-	const auto* Found = TickerModules.Find(ModuleName);
-	if (!Found) return nullptr;
-	return static_cast<T*>(Found->Get());
+	return static_cast<const T*>(FindModuleByTypeId(T::GetModuleTypeId()));
 }
@@ -0,0 +1,88 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "StaticTickerManager.h"
+
+/**
+ * Общие инструменты замеров TickerSystem, доступны в сборках с WITH_TICKER_INSTRUMENTATION.
+ * Замеры запускаются консольными командами Ticker.Benchmark.* и DAS.Benchmark.*, в том числе без рендера:
+ * UnrealEditor-Cmd <Project>.uproject -game -nullrhi -unattended -ExecCmds="Ticker.Benchmark.Modules; quit"
+ * Результаты пишутся в лог и в CSV в Saved/Profiling/TickerBenchmarks.
+ */
+#if WITH_TICKER_INSTRUMENTATION
+
+/**
+ * Менеджер для замеров: открывает регистрацию модулей и ручной тик.
+ * Время у менеджера своё и двигается шагами через AdvanceTime, глобальное время FApp и другие менеджеры замер не трогает.
+ */
+class FTickerBenchmarkManager final : public FStaticTickerManager
+{
+	double CurrentTime = FApp::GetCurrentTime();
+
+	virtual double GetSourceTime() const override { return CurrentTime; }
+public:
+	FTickerBenchmarkManager()
+	{
+		TickerDebugName = TEXT("TickerBenchmark");
+	}
+
+	using FStaticTickerManager::AddTickerModule;
+	using FStaticTickerManager::RegisterTickerModule;
+	using FStaticTickerManager::GetTickerModuleMutable;
+	using FStaticTickerManager::TickImmediately;
+
+	FORCEINLINE void AdvanceTime(const double DeltaTime) { CurrentTime += DeltaTime; }
+
+	FORCENOINLINE bool DrainIfPending()
+	{
+		if (!HasPendingCommands()) return false;
+		ExecutePendingCommands();
+		return true;
+	}
+};
+
+/** Таблица результатов одного замера: одна строка на случай и размер нагрузки */
+class TICKERSYSTEM_API FTickerBenchmarkReport
+{
+	FString BenchmarkName;
+	TArray<FString> Rows;
+
+	double StartSeconds = 0.0;
+	uint64 StartAllocations = 0;
+public:
+	explicit FTickerBenchmarkReport(const FString& InBenchmarkName);
+
+	/** Количество вызовов аллокатора с начала работы, 0 если аллокатор их не считает */
+	static uint64 GetAllocationCount();
+
+	/** Начинает замер участка, время и аллокации считаются до ближайшего AddSample */
+	FORCEINLINE void BeginSample()
+	{
+		StartAllocations = GetAllocationCount();
+		StartSeconds = FPlatformTime::Seconds();
+	}
+
+	/** Заканчивает замер участка и добавляет строку: Operations - количество тиков или операций внутри участка */
+	void AddSample(const FString& Case, const int64 Size, const int64 Operations);
+
+	/** Записывает CSV и возвращает путь к файлу */
+	FString Save() const;
+};
+
+namespace TickerBenchmarks
+{
+	/** Разбирает размеры нагрузки из аргументов начиная с FirstArg, без них возвращает Defaults */
+	inline TArray<int32> ParseSizes(const TArray<FString>& Args, const int32 FirstArg, std::initializer_list<int32> Defaults)
+	{
+		TArray<int32> Sizes;
+		for (int32 Index = FirstArg; Index < Args.Num(); ++Index)
+		{
+			if (const int32 Size = FCString::Atoi(*Args[Index]); Size > 0) Sizes.Add(Size);
+		}
+		if (Sizes.IsEmpty()) Sizes = Defaults;
+		return Sizes;
+	}
+}
+
+#endif
@@ -0,0 +1,69 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Инструментирование TickerSystem: STAT группа, счётчики модулей и канал трейса для Unreal Insights.
+ * WITH_TICKER_INSTRUMENTATION выставляется в TickerSystem.Build.cs и выключен в Shipping, тогда все макросы ниже пустые.
+ */
+#if WITH_TICKER_INSTRUMENTATION
+
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+DECLARE_STATS_GROUP(TEXT("TickerSystem"), STATGROUP_TickerSystem, STATCAT_Advanced);
+
+UE_TRACE_CHANNEL_EXTERN(TickerChannel, TICKERSYSTEM_API);
+
+/**
+ * Данные инструментирования одного модуля, создаются при его регистрации в менеджере.
+ * STAT счётчики заводятся по имени вида менеджера и общие для всех его экземпляров, так как динамические статы не удаляются,
+ * поэтому количества задач складываются из вкладов модулей. Имя экземпляра попадает только в скоуп трейса.
+ */
+struct TICKERSYSTEM_API FTickerModuleInstrumentation
+{
+	~FTickerModuleInstrumentation();
+
+	void Init(const FString& StatManagerName, const FString& TraceManagerName, const FName ModuleName);
+
+	/** Имя скоупа трейса вида Manager/Module */
+	FString TraceName;
+#if STATS
+	TStatId TickStatId;
+	TStatId TaskCountStatId;
+	TStatId DeferredStatId;
+
+	/** Вклад модуля в общие счётчики, при новом значении счётчик сдвигается на разницу */
+	int32 ReportedTaskCount = 0;
+	int32 ReportedDeferredCount = 0;
+
+	static void ReportCount(const TStatId StatId, int32& ReportedCount, const int32 Count);
+#endif
+};
+
+#define TICKER_SCOPE_MANAGER(ManagerName) TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(ManagerName, TickerChannel)
+
+#if STATS
+	#define TICKER_SCOPE_MODULE(Instrumentation) \
+		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(*(Instrumentation).TraceName, TickerChannel); \
+		FScopeCycleCounter TickerModuleCycleCounter((Instrumentation).TickStatId)
+	#define TICKER_SET_TASK_COUNT(Instrumentation, Count) \
+		FTickerModuleInstrumentation::ReportCount((Instrumentation).TaskCountStatId, (Instrumentation).ReportedTaskCount, Count)
+	#define TICKER_SET_DEFERRED_COUNT(Instrumentation, Count) \
+		FTickerModuleInstrumentation::ReportCount((Instrumentation).DeferredStatId, (Instrumentation).ReportedDeferredCount, Count)
+#else
+	#define TICKER_SCOPE_MODULE(Instrumentation) TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(*(Instrumentation).TraceName, TickerChannel)
+	#define TICKER_SET_TASK_COUNT(Instrumentation, Count)
+	#define TICKER_SET_DEFERRED_COUNT(Instrumentation, Count)
+#endif
+
+#else
+
+#define TICKER_SCOPE_MANAGER(ManagerName)
+#define TICKER_SCOPE_MODULE(Instrumentation)
+#define TICKER_SET_TASK_COUNT(Instrumentation, Count)
+#define TICKER_SET_DEFERRED_COUNT(Instrumentation, Count)
+
+#endif
@@ -2,12 +2,58 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "TickerInstrumentation.h"
 
 #define GENERATED_TICKER_BODY(Name) \
 	public: \
 		static FName GetModuleName() { return Name; } \
+		static int32 GetModuleTypeId() { static const int32 TypeId = FTickerModuleTypeRegistry::GetTypeId(Name); return TypeId; } \
 	private:
 
+/**
+ * Реестр номеров типов модулей. Номер выдаётся по имени модуля один раз и дальше используется как индекс в массивах менеджера.
+ * Номер привязан к имени, а не к static переменной, поэтому совпадает во всех модулях движка, где раскрыт GENERATED_TICKER_BODY.
+ */
+struct TICKERSYSTEM_API FTickerModuleTypeRegistry
+{
+	/** Возвращает номер типа модуля, при первом обращении к имени выдаёт новый */
+	static int32 GetTypeId(const FName ModuleName);
+
+	/** Возвращает номер типа модуля или INDEX_NONE, если такое имя ещё не регистрировалось */
+	static int32 FindTypeId(const FName ModuleName);
+};
+
+/** Режим, по которому менеджер решает, когда модулю нужен Tick */
+enum class ETickerModuleRateType : uint8
+{
+	/** Модуль обновляется на каждом тике менеджера */
+	EveryFrame,
+	/** Модуль обновляется с периодом TickRate */
+	FixedRate,
+	/** Модуль сам сообщает через GetNextUpdateDelay, когда ему нужно следующее обновление */
+	Deadline,
+};
+
+/**
+ * Фаза, в которой модуль обновляется. Core - главный тикер движка вне тика мира,
+ * остальные фазы привязаны к группам тика мира и выполняются по порядку с компонентами и физикой.
+ */
+enum class ETickerPhase : uint8
+{
+	/** Обновление из FTSTicker, вне тика мира */
+	Core,
+	/** Группа TG_PrePhysics, до компонентов движения и симуляции физики */
+	PrePhysics,
+	/** Группа TG_DuringPhysics, параллельно с симуляцией физики */
+	DuringPhysics,
+	/** Группа TG_PostPhysics, после симуляции физики */
+	PostPhysics,
+	/** Группа TG_PostUpdateWork, после обновления камеры и анимаций */
+	PostUpdateWork,
+
+	Num
+};
+
 /** Обработчик задачи, подключённый к FStaticTickerManager для выполнения во времени */
 class TICKERSYSTEM_API FTickerModule
 {
@@ -18,12 +64,50 @@ private:
 	friend class FStaticTickerManager;
 
 	bool bIsGamePaused = false;
+
+	/** Выставляется когда модуль получил новую работу и должен быть обновлён на ближайшем тике менеджера */
+	bool bWakeRequested = false;
+
+	/** Учтён ли модуль в счётчике занятых модулей менеджера */
+	bool bIsBusy = false;
+
+	/** Выставляется модулем из Tick, если он не успел обработать всю работу в бюджет кадра */
+	bool bSliceRequested = false;
+
+	/** Время менеджера, когда модулю в следующий раз нужен Tick */
+	double NextTickTime = 0.0;
+
+	/** Время менеджера на момент последнего Tick модуля, от него считается DeltaTime модуля */
+	double LastTickTime = 0.0;
+
+	/** Номер типа модуля, индекс в ModulesByTypeId менеджера */
+	int32 ModuleTypeId = INDEX_NONE;
+
+	/** DeltaTime, подготовленный менеджером для Tick модуля в текущей волне */
+	float PendingDeltaTime = 0.f;
+
+#if WITH_TICKER_INSTRUMENTATION
+	FTickerModuleInstrumentation Instrumentation;
+#endif
 	
 	/** Владелец - менеджер модуля */
-	FStaticTickerManager* OwnerManager;
+	FStaticTickerManager* OwnerManager = nullptr;
 protected:
 	FORCEINLINE bool GetIsGamePaused() const { return bIsGamePaused; }
 
+	/**
+	 * Доля реального времени, ещё не отработанная шагом симуляции, от 0 до 1.
+	 * В режиме фиксированного шага менеджера нужна для интерполяции между двумя последними состояниями, иначе всегда 1.
+	 */
+	float GetInterpolationAlpha() const;
+
+	/**
+	 * Время, прошедшее с последнего Tick модуля. Модуль, спящий до дальнего дедлайна, не обновляет своё время,
+	 * поэтому задачи, добавленные между тиками, отсчитывают свои задержки от времени модуля плюс это значение.
+	 * Для свободного модуля и на паузе возвращает 0, так как это время в DeltaTime модуля не попадёт.
+	 */
+	double GetTimeSinceLastTick() const;
+
 	/** Функция, которая вызывается каждый тик (или настроенное во владельце время),
 	 * также важно отметить что тик в менеджере может быть выключен и вызов этой функции подкрутится. */
 	virtual void Tick(float DeltaTime) {}
@@ -40,17 +124,75 @@ protected:
 	/** Вызывается из менеджера для проверки нужен ли модулю tick, если нужен то возвращаем true, иначе false */
 	virtual bool NeedUpdate() const { return false; }
 
-	/** Функция для попытки начать работу tich в менеджера */	
-	void TryStartTicker() const;
+	/**
+	 * Вызывается для модулей с ETickerModuleRateType::Deadline после каждого их Tick.
+	 * Должна вернуть через сколько секунд (от последнего Tick модуля) ему снова понадобится обновление.
+	 */
+	virtual double GetNextUpdateDelay() const { return 0.0; }
+
+	/** Количество активных задач модуля, выводится в STAT группу TickerSystem */
+	virtual int32 GetActiveTaskCount() const { return NeedUpdate() ? 1 : 0; }
+
+	/**
+	 * Остался ли бюджет кадра менеджера. Модули с большим количеством задач проверяют его во время Tick,
+	 * прерывают обработку и продолжают её на следующем тике через RequestNextSlice. Без бюджета всегда true.
+	 */
+	bool HasFrameBudget() const;
+
+	/** Просит менеджер обновить модуль на следующем тике, чтобы продолжить прерванную по бюджету работу */
+	FORCEINLINE void RequestNextSlice() { bSliceRequested = true; }
+
+	/** Сообщает количество задач, отложенных на следующий тик, выводится в STAT группу TickerSystem */
+	FORCEINLINE void ReportDeferredWork(const int32 DeferredCount)
+	{
+		TICKER_SET_DEFERRED_COUNT(Instrumentation, DeferredCount);
+	}
+
+	/**
+	 * Сообщает менеджеру, что у модуля появилась работа: модуль считается занятым, тикер запускается и будит модуль к ближайшему тику.
+	 * Вызывается при добавлении задачи.
+	 */
+	void TryStartTicker();
 	/** Функция для попытки закончить работу tich в менеджере */	
 	void TryEndTicker() const;
 
-	/** Функция для попытки закончить работу tich в менеджере, с проверкой нужен ли тикер этому модулю */	
-	void TryEndTickerSave() const;
+	/**
+	 * Сообщает менеджеру, что модуль мог освободиться. Если NeedUpdate вернул false, модуль перестаёт считаться занятым,
+	 * и если занятых модулей больше нет, тикер сразу снимается. Вызывается при удалении задачи.
+	 */
+	void TryEndTickerSave();
 
 	/** Имя модуля нужное для его регистрации в системе */
 	FName ModuleName = NAME_None;
 
 	/** Останавливать ли обновление модуля во время паузы */
 	bool bTickInPauseDisabled = true;
+
+	/** Порядок модуля в менеджере: модули с меньшим приоритетом обновляются и получают события раньше */
+	int32 TickPriority = 0;
+
+	/** Режим планирования Tick модуля */
+	ETickerModuleRateType TickRateType = ETickerModuleRateType::EveryFrame;
+
+	/** Период обновления модуля в секундах, используется только с ETickerModuleRateType::FixedRate */
+	float TickRate = 0.f;
+
+	/**
+	 * Можно ли вызывать Tick модуля вне игрового потока, параллельно с другими такими модулями.
+	 * Tick такого модуля не должен трогать UObject и вызывать функции менеджера (TryStartTicker, TryEndTicker и т.д.).
+	 */
+	bool bThreadSafeTick = false;
+
+	/**
+	 * Имена модулей, данные которых модуль читает или изменяет в своём Tick.
+	 * Эти модули обновляются раньше в том же тике менеджера и никогда не выполняются параллельно с этим модулем.
+	 */
+	TArray<FName> TickPrerequisites;
+
+	/**
+	 * Фаза обновления модуля. Фазы мира работают только когда менеджер привязан к миру через BindTickPhases,
+	 * иначе модуль обновляется главным тикером. Фиксированный шаг менеджера действует только на фазу Core.
+	 * Зависимости из TickPrerequisites учитываются только между модулями одной фазы.
+	 */
+	ETickerPhase TickPhase = ETickerPhase::Core;
 };
\ No newline at end of file
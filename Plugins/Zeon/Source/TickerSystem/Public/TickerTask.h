@@ -0,0 +1,118 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include <coroutine>
+
+class FCoroutineTickerModule;
+
+/**
+ * Пул кадров корутин тикера: кадры одного размерного класса переиспользуются, поэтому запуск корутины не ходит в аллокатор.
+ * Каждый размерный класс хранит ограниченное число свободных кадров, лишние сразу возвращаются в аллокатор.
+ */
+struct TICKERSYSTEM_API FTickerTaskFramePool
+{
+	static void* Allocate(const SIZE_T Size);
+	static void Free(void* Frame, const SIZE_T Size);
+
+	/** Возвращает в аллокатор все свободные кадры пула, вызывается при удалении модуля корутин */
+	static void Trim();
+};
+
+/** Идентификатор запущенной корутины в FCoroutineTickerModule, устаревший идентификатор безопасно игнорируется */
+struct FTickerTaskHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Serial = 0;
+
+	FORCEINLINE bool IsValid() const { return Index != INDEX_NONE; }
+	FORCEINLINE bool operator==(const FTickerTaskHandle& Other) const { return Index == Other.Index && Serial == Other.Serial; }
+};
+
+/**
+ * Корутина, которую выполняет FCoroutineTickerModule.
+ * Создаётся приостановленной и начинает выполняться только после FCoroutineTickerModule::Launch, дальше её возобновляет тикер:
+ *	co_await TickerTask::NextTick();
+ *	co_await TickerTask::Seconds(0.5f);
+ * Кадр корутины берётся из FTickerTaskFramePool, шаги корутины не создают лямбд и не выделяют память.
+ */
+class TICKERSYSTEM_API FTickerTask
+{
+public:
+	struct promise_type
+	{
+		FCoroutineTickerModule* Module = nullptr;
+		FTickerTaskHandle Handle;
+
+		FTickerTask get_return_object() { return FTickerTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		/** Кадр уничтожает модуль, после того как уберёт корутину из своих таблиц */
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() {}
+		void unhandled_exception() { check(false); }
+
+		static void* operator new(const SIZE_T Size) { return FTickerTaskFramePool::Allocate(Size); }
+		static void operator delete(void* Frame, const SIZE_T Size) { FTickerTaskFramePool::Free(Frame, Size); }
+	};
+	using FHandle = std::coroutine_handle<promise_type>;
+
+	FTickerTask() = default;
+	explicit FTickerTask(const FHandle InCoroutine) : Coroutine(InCoroutine) {}
+
+	FTickerTask(const FTickerTask&) = delete;
+	FTickerTask& operator=(const FTickerTask&) = delete;
+
+	FTickerTask(FTickerTask&& Other) noexcept : Coroutine(Other.Coroutine) { Other.Coroutine = nullptr; }
+	FTickerTask& operator=(FTickerTask&& Other) noexcept
+	{
+		if (this != &Other)
+		{
+			if (Coroutine) Coroutine.destroy();
+			Coroutine = Other.Coroutine;
+			Other.Coroutine = nullptr;
+		}
+		return *this;
+	}
+
+	/** Корутина, которую так и не запустили, уничтожается вместе с объектом */
+	~FTickerTask()
+	{
+		if (Coroutine) Coroutine.destroy();
+	}
+
+	FORCEINLINE bool IsValid() const { return static_cast<bool>(Coroutine); }
+
+	/** Отдаёт владение кадром, вызывается модулем при запуске */
+	FORCEINLINE FHandle Release()
+	{
+		const FHandle Released = Coroutine;
+		Coroutine = nullptr;
+		return Released;
+	}
+private:
+	FHandle Coroutine = nullptr;
+};
+
+namespace TickerTask
+{
+	/** Возобновляет корутину на следующем тике модуля */
+	struct TICKERSYSTEM_API FNextTickAwaiter
+	{
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(FTickerTask::FHandle Coroutine) const;
+		void await_resume() const noexcept {}
+	};
+
+	/** Возобновляет корутину через заданное время модуля, пауза в это время не засчитывается */
+	struct TICKERSYSTEM_API FSecondsAwaiter
+	{
+		float Seconds;
+
+		bool await_ready() const noexcept { return Seconds <= 0.f; }
+		void await_suspend(FTickerTask::FHandle Coroutine) const;
+		void await_resume() const noexcept {}
+	};
+
+	FORCEINLINE FNextTickAwaiter NextTick() { return {}; }
+	FORCEINLINE FSecondsAwaiter Seconds(const float InSeconds) { return { InSeconds }; }
+}
@@ -0,0 +1,46 @@
+﻿
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TickerWorldSubsystem.generated.h"
+
+class FStaticTickerManager;
+
+/**
+ * Реестр менеджеров тикера одного мира.
+ * Подписывается на начало игры, завершение и паузу один раз на мир и раздаёт события только менеджерам своего мира,
+ * поэтому в PIE с несколькими клиентами и на listen сервере пауза или завершение одного мира не трогает менеджеры других,
+ * а глобальные делегаты вызываются по одному разу на мир, а не на каждый менеджер.
+ */
+UCLASS()
+class TICKERSYSTEM_API UTickerWorldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	/** Менеджеры мира в порядке регистрации */
+	TArray<FStaticTickerManager*> Managers;
+
+	FDelegateHandle WorldBeginPlayDelegateHandle;
+	FDelegateHandle WorldTearDownDelegateHandle;
+	FDelegateHandle GamePauseDelegateHandle;
+
+	/** Вызывает Function для менеджеров мира, менеджеры убранные во время обхода пропускаются */
+	template<typename FunctionT>
+	void ForEachManager(FunctionT Function);
+
+	/** Делегат самого мира, срабатывает после BeginPlay акторов, как и FZeonUtil::OnWorldBeginPlay */
+	void OnWorldStarted();
+	void OnWorldTearDown(UWorld* World);
+	void OnGamePause(const UWorld* World, bool bPaused);
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	void RegisterManager(FStaticTickerManager* Manager);
+	void UnregisterManager(FStaticTickerManager* Manager);
+
+	FORCEINLINE int32 GetManagerCount() const { return Managers.Num(); }
+};
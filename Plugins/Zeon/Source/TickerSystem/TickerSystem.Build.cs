@@ -17,5 +17,8 @@ public class TickerSystem : ModuleRules
 				"Zeon",
 			}
 		);
+
+		var WithInstrumentation = Target.Configuration != UnrealTargetConfiguration.Shipping;
+		PublicDefinitions.Add(WithInstrumentation ? "WITH_TICKER_INSTRUMENTATION=1" : "WITH_TICKER_INSTRUMENTATION=0");
 	}
 }
\ No newline at end of file
@@ -29,7 +29,8 @@ public:
 		return *Instance;
 	}
 public:
-	DECLARE_MULTICAST_DELEGATE_OneParam(FOnGamePause, bool /*bPaused*/);
+	/** Пауза конкретного мира, подписчики сами отбрасывают события чужих миров */
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnGamePause, const UWorld* /*World*/, bool /*bPaused*/);
 	static FOnGamePause OnGamePause;
 
 	
@@ -52,7 +53,7 @@ public:
 	{
 		if (UGameplayStatics::IsGamePaused(World) != bPaused)
 		{
-			OnGamePause.Broadcast(bPaused);
+			OnGamePause.Broadcast(World, bPaused);
 			return UGameplayStatics::SetGamePaused(World, bPaused);
 		}
 		return false;
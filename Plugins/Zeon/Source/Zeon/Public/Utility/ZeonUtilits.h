@@ -13,7 +13,7 @@ class ZEON_API FZeonUtil
 	
 	static void OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues /*IVS*/)
 	{
-		World->OnWorldBeginPlay.AddLambda([WorldType = World->WorldType]{ OnWorldBeginPlay.Broadcast(WorldType); });
+		World->OnWorldBeginPlay.AddLambda([World]{ OnWorldBeginPlay.Broadcast(World, World->WorldType); });
 	}
 
 public:
@@ -39,7 +39,7 @@ public:
 
 
 public:
-	DECLARE_MULTICAST_DELEGATE_OneParam(FOnWorldBeginPlay, EWorldType::Type /*WorldType*/);
+	DECLARE_MULTICAST_DELEGATE_TwoParams(FOnWorldBeginPlay, UWorld* /*World*/, EWorldType::Type /*WorldType*/);
 	static FOnWorldBeginPlay OnWorldBeginPlay;
 	
 